@@ -63,3 +63,36 @@ async function* select(promises) {
     yield await Promise.any(promises);
   }
 }
+
+// Many requests completing while immediates are pending are found ready together by a single
+// poll, and then handed out one per event loop turn.
+routes.set('/async-select/fan-out-with-immediates', async () => {
+  let done = false;
+  let ticks = 0;
+  const tick = () => {
+    ticks++;
+    if (!done) {
+      setTimeout(tick, 0);
+    }
+  };
+  setTimeout(tick, 0);
+
+  const responses = await Promise.all(
+    Array.from({ length: 20 }, () =>
+      fetch('https://compute-sdk-test-backend.edgecompute.app/async_select_1', {
+        backend: 'TheOrigin',
+      }),
+    ),
+  );
+  done = true;
+
+  for (const response of responses) {
+    if (response.headers.get('fooname') == null) {
+      throw new Error('Missing fooname header on a fanned out response');
+    }
+  }
+  if (ticks === 0) {
+    throw new Error('Timers did not run while requests were pending');
+  }
+  return new Response('pong');
+});
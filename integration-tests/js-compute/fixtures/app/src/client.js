@@ -13,6 +13,40 @@ routes.set('/client/requestId', (event) => {
     'event.client.requestId.length',
   );
 });
+routes.set('/client/addressOctets', (event) => {
+  const octets = event.client.addressOctets;
+  strictEqual(
+    octets instanceof Uint8Array,
+    true,
+    'event.client.addressOctets instanceof Uint8Array',
+  );
+  strictEqual(
+    octets.length === 4 || octets.length === 16,
+    true,
+    'octets.length is 4 or 16',
+  );
+  strictEqual(
+    event.client.addressOctets !== octets,
+    true,
+    'event.client.addressOctets returns a new array on each access',
+  );
+  const geo = JSON.stringify(event.client.geo);
+  const original = Array.from(octets);
+  octets.fill(0);
+  strictEqual(
+    Array.from(event.client.addressOctets).join(),
+    original.join(),
+    'modifying the returned octets does not change the client address',
+  );
+  strictEqual(
+    JSON.stringify(event.client.geo),
+    geo,
+    'modifying the returned octets does not change event.client.geo',
+  );
+  if (octets.length === 4) {
+    strictEqual(octets.join('.'), event.client.address, 'octets match address');
+  }
+});
 routes.set('/client/tlsJA3MD5', (event) => {
   if (isRunningLocally()) {
     strictEqual(event.client.tlsJA3MD5, null);
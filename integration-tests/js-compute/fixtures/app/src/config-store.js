@@ -1,7 +1,7 @@
 /// <reference path="../../../../../types/index.d.ts" />
 
 /* eslint-env serviceworker */
-import { assert } from './assertions.js';
+import { assert, assertThrows } from './assertions.js';
 import { ConfigStore } from 'fastly:config-store';
 import { routes } from './routes.js';
 import { env } from 'fastly:env';
@@ -17,3 +17,42 @@ routes.set('/config-store', () => {
     `config.get("twitter") === "https://twitter.com/fastly"`,
   );
 });
+
+routes.set('/config-store/get-many', () => {
+  let config = new ConfigStore(CONFIG_STORE_NAME);
+  assertThrows(() => config.getMany('twitter'), TypeError);
+  assertThrows(() => config.getMany(['twitter', '']), TypeError);
+  let result = config.getMany(['twitter', 'missing']);
+  assert(
+    result,
+    { twitter: 'https://twitter.com/fastly', missing: null },
+    `config.getMany(['twitter', 'missing'])`,
+  );
+  assert(
+    Object.keys(config.getMany(['missing', 'twitter'])),
+    ['missing', 'twitter'],
+    `getMany() keeps the order of the keys`,
+  );
+});
+
+routes.set('/config-store/cache', () => {
+  assertThrows(() => ConfigStore.enableCache('60'), TypeError);
+  assertThrows(() => ConfigStore.enableCache({ ttl: -1 }), RangeError);
+  assertThrows(() => ConfigStore.enableCache({ maxEntries: 1.5 }), RangeError);
+
+  ConfigStore.enableCache({ ttl: 60000, maxEntries: 10 });
+  try {
+    let config = new ConfigStore(CONFIG_STORE_NAME);
+    let before = ConfigStore.cacheStats();
+    let first = config.get('twitter');
+    let second = config.get('twitter');
+    let after = ConfigStore.cacheStats();
+    assert(first, 'https://twitter.com/fastly', `first lookup`);
+    assert(second, first, `cached lookup === first lookup`);
+    assert(after.hits - before.hits >= 1, true, `cacheStats().hits increased`);
+    assert(after.size >= 1, true, `cacheStats().size >= 1`);
+  } finally {
+    ConfigStore.disableCache();
+  }
+  assert(ConfigStore.cacheStats().size, 0, `disableCache() clears entries`);
+});
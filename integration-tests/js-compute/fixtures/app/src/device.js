@@ -7,7 +7,7 @@ import { routes } from './routes.js';
 
 routes.set('/device/interface', () => {
   let actual = Reflect.ownKeys(Device);
-  let expected = ['prototype', 'lookup', 'length', 'name'];
+  let expected = ['prototype', 'lookup', 'cacheStats', 'length', 'name'];
   assert(actual, expected, `Reflect.ownKeys(Device)`);
 
   // Check the prototype descriptors are correct
@@ -407,3 +407,20 @@ routes.set('/device/lookup/bot-detection', () => {
   assert(device.brand, 'Google', `device.brand`);
   assert(device.isBot, true, `device.isBot`);
 });
+
+routes.set('/device/lookup/cached', () => {
+  let useragent = 'Googlebot/2.1 (+http://www.google.com/bot.html)';
+  let first = Device.lookup(useragent);
+  let before = Device.cacheStats();
+  let second = Device.lookup(useragent);
+  let after = Device.cacheStats();
+
+  assert(after.hits, before.hits + 1, `Device.cacheStats().hits`);
+  assert(after.misses, before.misses, `Device.cacheStats().misses`);
+  assert(second !== first, true, `each lookup returns a new Device`);
+  assert(second.toJSON(), first.toJSON(), `second.toJSON()`);
+
+  let unknown = `unknown-${Math.random()}`;
+  assert(Device.lookup(unknown), null, `Device.lookup(unknown)`);
+  assert(Device.lookup(unknown), null, `cached Device.lookup(unknown)`);
+});
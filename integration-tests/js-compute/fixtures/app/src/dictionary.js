@@ -195,6 +195,21 @@ const DICTIONARY_NAME = env('DICTIONARY_NAME');
       );
     });
   }
+  // Dictionary.prototype.getMany
+  {
+    routes.set('/dictionary/get-many', () => {
+      let store = createValidDictionary();
+      assertThrows(() => store.getMany('twitter'), TypeError);
+      assertThrows(() => store.getMany(['twitter', '']), TypeError);
+      assertThrows(() => store.getMany(['a'.repeat(256)]), TypeError);
+      let result = store.getMany(['twitter', 'missing']);
+      assert(
+        result,
+        { twitter: 'https://twitter.com/fastly', missing: null },
+        `store.getMany(['twitter', 'missing'])`,
+      );
+    });
+  }
 }
 
 function dictionaryInterfaceTests() {
@@ -242,7 +257,7 @@ function dictionaryInterfaceTests() {
   );
 
   actual = Reflect.ownKeys(Dictionary.prototype);
-  expected = ['constructor', 'get'];
+  expected = ['constructor', 'get', 'getMany'];
   assert(actual, expected, `Reflect.ownKeys(Dictionary.prototype)`);
 
   actual = Reflect.getOwnPropertyDescriptor(
@@ -3,7 +3,7 @@
 
 import { assert } from './assertions.js';
 import { routes } from './routes.js';
-import { sdkVersion } from 'fastly:experimental';
+import { enableProfiling, profile, sdkVersion } from 'fastly:experimental';
 
 routes.set('/fastly/now', function () {
   assert(typeof fastly.now, 'function', 'typeof fastly.now');
@@ -26,3 +26,41 @@ routes.set('/fastly/version', function () {
     'fastly.sdkVersion matches fastly:experimental#sdkVersion',
   );
 });
+
+routes.set('/fastly/baseurl', function () {
+  // A relative request URL is resolved against the origin of the client request.
+  const request = new Request('/relative?x=1');
+  assert(request.url, `${location.origin}/relative?x=1`, 'request.url');
+
+  assert(fastly.baseURL instanceof URL, true, 'fastly.baseURL instanceof URL');
+  assert(fastly.baseURL.href, `${location.origin}/`, 'fastly.baseURL.href');
+
+  fastly.baseURL = new URL('https://www.fastly.com/base/');
+  assert(
+    new Request('relative').url,
+    'https://www.fastly.com/base/relative',
+    'request.url with an explicit baseURL',
+  );
+});
+
+routes.set('/fastly/profile', async function () {
+  assert(fastly.profile, profile, 'fastly.profile is fastly:experimental#profile');
+  assert(profile(), null, 'profile() while profiling is disabled');
+
+  enableProfiling(true);
+  try {
+    // Creating a response makes hostcalls for its handle and body.
+    new Response('profiled');
+    const result = profile();
+    assert(typeof result.handlerTime, 'number', 'typeof result.handlerTime');
+    const hostcalls = Object.entries(result.hostcalls);
+    assert(hostcalls.length > 0, true, 'hostcalls were recorded');
+    for (const [name, { calls, time }] of hostcalls) {
+      assert(calls > 0, true, `${name} calls`);
+      assert(time >= 0, true, `${name} time`);
+    }
+  } finally {
+    enableProfiling(false);
+  }
+  assert(profile(), null, 'profile() after disabling profiling');
+});
@@ -180,6 +180,25 @@ routes.set(
   },
 );
 
+routes.set('/fastly/getgeolocationforipaddress/repeated-lookups', async () => {
+  const first = fastly.getGeolocationForIpAddress('151.101.1.1');
+  if (isRunningLocally()) {
+    strictEqual(first, null);
+    strictEqual(fastly.getGeolocationForIpAddress('151.101.1.1'), null);
+    return;
+  }
+  const expected = JSON.stringify(first);
+  first.city = 'mutated';
+  const second = fastly.getGeolocationForIpAddress('151.101.1.1');
+  strictEqual(first !== second, true, 'each lookup returns a new object');
+  strictEqual(JSON.stringify(second), expected, 'repeated lookup result');
+  assert(
+    Object.keys(second),
+    geoFields,
+    `Object.keys(fastly.getGeolocationForIpAddress('151.101.1.1')) == geoFields`,
+  );
+});
+
 routes.set(
   '/fastly/getgeolocationforipaddress/parameter-compressed-ipv6-string',
   async () => {
@@ -51,3 +51,29 @@ routes.set('/headers/from-response/set-delete', async () => {
   response.headers.delete('access-control-allow-origin');
   return response;
 });
+
+routes.set('/headers/request/recommit', async () => {
+  const request = new Request('https://http-me.fastly.dev/anything', {
+    headers: { 'x-keep': 'keep', 'x-change': 'before', 'x-remove': 'gone' },
+    backend: 'httpme',
+    cacheOverride: new CacheOverride('pass'),
+  });
+  // Reading isCacheable commits the headers to the request's handle, so sending the request
+  // commits them a second time, after these changes.
+  request.isCacheable;
+  request.headers.set('x-change', 'after');
+  request.headers.delete('x-remove');
+  request.headers.append('x-added', 'one');
+  const response = await fetch(request);
+  const body = await response.json();
+  const received = Object.fromEntries(
+    Object.entries(body.headers).map(([name, value]) => [
+      name.toLowerCase(),
+      value,
+    ]),
+  );
+  assert(received['x-keep'], 'keep', 'x-keep');
+  assert(received['x-change'], 'after', 'x-change');
+  assert(received['x-remove'], undefined, 'x-remove');
+  assert(received['x-added'], 'one', 'x-added');
+});
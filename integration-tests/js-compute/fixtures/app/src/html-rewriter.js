@@ -1,7 +1,10 @@
 /* eslint-env serviceworker */
 
 import { routes } from './routes.js';
-import { HTMLRewritingStream } from 'fastly:html-rewriter';
+import {
+  HTMLRewritingStream,
+  HTMLRewritingStreamTemplate,
+} from 'fastly:html-rewriter';
 import {
   assert,
   assertThrows,
@@ -318,3 +321,118 @@ routes.set('/html-rewriter/access-freed-element', async () => {
 
   assertThrows(() => savedEl.tag);
 });
+
+// The rewriter's output is written straight into the downstream body when its readable end is
+// used as the response body, so check that everything still arrives in order.
+routes.set('/html-rewriter/response-body', async () => {
+  const paragraphs = [];
+  for (let i = 0; i < 10; i++) {
+    paragraphs.push(`<p class="p${i}">${i}</p>`);
+  }
+  const toRewrite = `<html><body>${paragraphs.join('')}</body></html>`;
+  const body = new Response(toRewrite).body.pipeThrough(
+    new HTMLRewritingStream().onElement('p', (e) => {
+      e.setAttribute('class', 'rewritten');
+    }),
+  );
+  return new Response(body, { headers: { 'Content-Type': 'text/html' } });
+});
+
+// A host-backed body piped into the rewriter is read natively across several tasks; make sure
+// every element is seen and the output is complete and in order.
+routes.set('/html-rewriter/host-body-large', async () => {
+  const count = 20000;
+  const paragraphs = [];
+  const expectedParagraphs = [];
+  for (let i = 0; i < count; i++) {
+    paragraphs.push(`<p>${i}</p>`);
+    expectedParagraphs.push(`<p data-i="${i}">${i}</p>`);
+  }
+  let seen = 0;
+  const body = new Response(
+    `<html><body>${paragraphs.join('')}</body></html>`,
+  ).body.pipeThrough(
+    new HTMLRewritingStream().onElement('p', (e) => {
+      e.setAttribute('data-i', String(seen++));
+    }),
+  );
+  const text = await new Response(body).text();
+  strictEqual(seen, count);
+  strictEqual(text, `<html><body>${expectedParagraphs.join('')}</body></html>`);
+});
+
+routes.set('/html-rewriter/memory-settings', async () => {
+  const toRewrite =
+    '<!DOCTYPE html><html><head><title>Test</title></head><body><h1>Hello, World!</h1></body></html>';
+  const expected =
+    '<!DOCTYPE html><html><head><title>Test</title></head><body><h1 id="rewritten">Hello, World!</h1></body></html>';
+  let body = new Response(toRewrite).body.pipeThrough(
+    new HTMLRewritingStream({
+      preallocatedParsingBufferSize: 4096,
+      maxAllowedMemoryUsage: 1024 * 1024,
+    }).onElement('h1', (e) => {
+      e.setAttribute('id', 'rewritten');
+    }),
+  );
+  strictEqual(await new Response(body).text(), expected);
+});
+
+routes.set('/html-rewriter/invalid-memory-settings', async () => {
+  assertThrows(() => new HTMLRewritingStream('not an object'), Error);
+  assertThrows(
+    () => new HTMLRewritingStream({ preallocatedParsingBufferSize: -1 }),
+    Error,
+  );
+  assertThrows(
+    () => new HTMLRewritingStream({ maxAllowedMemoryUsage: 1.5 }),
+    Error,
+  );
+  assertThrows(
+    () =>
+      new HTMLRewritingStream({
+        preallocatedParsingBufferSize: 2048,
+        maxAllowedMemoryUsage: 1024,
+      }),
+    Error,
+  );
+});
+
+// A selector used by one rewriter is cached and shared with later rewriters, which must keep
+// working after the first one has been garbage collected.
+routes.set('/html-rewriter/shared-selector', async () => {
+  for (let i = 0; i < 3; i++) {
+    let body = new Response('<div><p>text</p></div>').body.pipeThrough(
+      new HTMLRewritingStream().onElement('div > p', (e) => {
+        e.setAttribute('data-i', String(i));
+      }),
+    );
+    strictEqual(
+      await new Response(body).text(),
+      `<div><p data-i="${i}">text</p></div>`,
+    );
+  }
+});
+
+// Built at initialization time, so the template is part of the snapshot.
+const headingTemplate = new HTMLRewritingStreamTemplate().onElement('h1', (e) => {
+  e.setAttribute('class', 'from-template');
+});
+
+routes.set('/html-rewriter/template', async () => {
+  const toRewrite = '<html><body><h1>Hello</h1><h2>World</h2></body></html>';
+  const expected =
+    '<html><body><h1 class="from-template">Hello</h1><h2>World</h2></body></html>';
+  for (let i = 0; i < 2; i++) {
+    const stream = headingTemplate.createStream();
+    strictEqual(stream instanceof HTMLRewritingStream, true);
+    const body = new Response(toRewrite).body.pipeThrough(stream);
+    strictEqual(await new Response(body).text(), expected);
+  }
+});
+
+routes.set('/html-rewriter/template-locked', async () => {
+  const template = new HTMLRewritingStreamTemplate().onElement('p', () => {});
+  const stream = template.createStream();
+  assertThrows(() => stream.onElement('div', () => {}), Error);
+  assertThrows(() => template.onElement('div', () => {}), Error);
+});
@@ -1125,3 +1125,26 @@ routes.set('/image-optimizer/clone-request', () => {
   });
   assertDoesNotThrow(() => req.clone());
 });
+
+routes.set('/image-optimizer/clone-request-with-body', async () => {
+  const body = 'an image request body '.repeat(10000);
+  const request = new Request('https://http-me.fastly.com/anything', {
+    method: 'POST',
+    body,
+    backend: 'httpme',
+  });
+  const cloned = request.clone();
+  // The image optimizer doesn't take streamed bodies, so sending the clone
+  // waits until the whole body has been copied into it.
+  const sent = fetch(cloned, {
+    imageOptimizerOptions: { region: Region.UsEast },
+  }).then(() => null, (error) => error);
+  assert(await request.text(), body, 'request.text()');
+  const error = await sent;
+  assert(
+    error?.message !==
+      'Request.prototype.clone: the request body could not be copied',
+    true,
+    'the clone was copied in full',
+  );
+});
@@ -1,4 +1,5 @@
 import { Logger, configureConsole } from 'fastly:logger';
+import { assertThrows } from './assertions.js';
 import { routes, isRunningLocally } from './routes';
 
 configureConsole({ prefixing: false, stderr: true });
@@ -17,3 +18,48 @@ routes.set('/logger', () => {
 
   return new Response();
 });
+
+routes.set('/logger/buffered', () => {
+  assertThrows(() => new Logger('ComputeLog', 'buffered'), Error);
+  assertThrows(() => new Logger('ComputeLog', { buffered: 'yes' }), Error);
+  assertThrows(() => configureConsole({ buffered: 'yes' }), Error);
+
+  if (isRunningLocally()) {
+    const logger = new Logger('ComputeLog', { buffered: true });
+    logger.log('Buffered 1');
+    logger.log('Buffered 2');
+  }
+
+  configureConsole({ buffered: true });
+  console.log('BUFFERED LOG');
+  console.error('BUFFERED ERROR');
+  configureConsole({ buffered: false });
+
+  return new Response();
+});
+
+routes.set('/logger/log-record', () => {
+  const logger = new Logger('ComputeLog');
+  assertThrows(() => logger.logRecord({}, 'json'), Error);
+  assertThrows(() => logger.logRecord({}, { format: 'xml' }), Error);
+  assertThrows(() => logger.logRecord('message', { format: 'kv' }), Error);
+  assertThrows(() => logger.logRecord(undefined), Error);
+  assertThrows(() => logger.logRecord({ n: 1n }), TypeError);
+
+  if (isRunningLocally()) {
+    logger.logRecord({ level: 'info', status: 200, tags: ['a', 'b'] });
+    logger.logRecord({ msg: 'café 😀' });
+    logger.logRecord(
+      {
+        level: 'warn',
+        msg: 'two words',
+        empty: '',
+        skipped: undefined,
+        n: 1.5,
+      },
+      { format: 'kv' },
+    );
+  }
+
+  return new Response();
+});
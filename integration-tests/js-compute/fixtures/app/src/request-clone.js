@@ -2,6 +2,7 @@
 
 import { assert, assertThrows } from './assertions.js';
 import { routes } from './routes.js';
+import { enableProfiling, profile } from 'fastly:experimental';
 
 routes.set('/request/clone/called-as-constructor', () => {
   assertThrows(
@@ -87,3 +88,58 @@ routes.set('/request/clone/invalid', async () => {
   await request.text();
   assertThrows(() => request.clone());
 });
+routes.set('/request/clone/downstream-body', async (event) => {
+  const request = event.request;
+  const cloned = request.clone();
+  const clonedText = await cloned.text();
+  const originalText = await request.text();
+  assert(
+    clonedText,
+    'a shadowed request body that both copies should see',
+    'clonedText',
+  );
+  assert(originalText, clonedText, 'originalText');
+  return new Response('ok');
+});
+routes.set('/request/clone/downstream-body-repeated', async (event) => {
+  const request = event.request;
+  const first = request.clone();
+  // The original is still being copied into, so this clone tees its stream.
+  const second = request.clone();
+  const expected = 'a shadowed request body that both copies should see';
+  assert(await new Response(first.body).text(), expected, 'first.body');
+  assert(await second.text(), expected, 'second.text()');
+  assert(await request.text(), expected, 'request.text()');
+  return new Response('ok');
+});
+routes.set('/request/clone/downstream-body-unused', async (event) => {
+  const request = event.request;
+  enableProfiling(true);
+  try {
+    // The body is only copied once one of the requests is read or sent, so a
+    // clone that's dropped unused doesn't read the body at all.
+    request.clone();
+    await new Promise((resolve) => setTimeout(resolve, 10));
+    const { hostcalls } = profile();
+    assert(hostcalls['HttpBody::read_into'], undefined, 'body reads');
+  } finally {
+    enableProfiling(false);
+  }
+  assert(
+    await request.text(),
+    'a shadowed request body that both copies should see',
+    'request.text()',
+  );
+  return new Response('ok');
+});
+routes.set('/request/clone/streamed-body', async () => {
+  const request = new Request('https://www.fastly.com', {
+    body: 'te',
+    method: 'post',
+  });
+  // Accessing the body creates its stream, so cloning has to tee the stream itself.
+  assert(request.body instanceof ReadableStream, true, 'request.body');
+  const cloned = request.clone();
+  assert(await cloned.text(), 'te', 'cloned.text()');
+  assert(await request.text(), 'te', 'request.text()');
+});
@@ -81,3 +81,23 @@ routes.set('/response/json', async () => {
     });
   }, CustomError);
 });
+
+// The JSON is written to the body in fixed-size pieces as it's serialized, so check a payload much
+// larger than one piece, with multi-byte characters and surrogate pairs straddling the piece
+// boundaries, round-trips exactly.
+routes.set('/response/json/large', async () => {
+  const value = {
+    ascii: 'a'.repeat(100000),
+    twoByte: 'é'.repeat(50000),
+    threeByte: '€'.repeat(50000),
+    astral: '😀'.repeat(50000),
+    loneSurrogate: '\ud800',
+    items: Array.from({ length: 10000 }, (_, i) => ({ i, s: `item ${i} ☃` })),
+  };
+  const text = await Response.json(value).text();
+  assert(text, JSON.stringify(value), 'text');
+  const data = await Response.json(value).json();
+  assert(data.astral, value.astral, 'data.astral');
+  assert(data.loneSurrogate, '\ud800', 'data.loneSurrogate');
+  assert(data.items.length, 10000, 'data.items.length');
+});
@@ -1,8 +1,12 @@
 /* eslint-env serviceworker */
 
 import { routes } from './routes.js';
-import { assert, streamToString } from './assertions.js';
-import { allowDynamicBackends } from 'fastly:experimental';
+import { assert, assertThrows, streamToString } from './assertions.js';
+import {
+  allowDynamicBackends,
+  enableProfiling,
+  profile,
+} from 'fastly:experimental';
 
 routes.set('/response/stall', async (event) => {
   // keep connection open 10 seconds
@@ -30,6 +34,127 @@ routes.set('/response/text/guest-backed-stream', async () => {
   );
 });
 
+// Host-backed bodies are read in chunks that grow with the body, so these cover reads that span
+// several chunk size increases.
+routes.set('/response/text/host-backed-large', async () => {
+  const size = 3 * 1024 * 1024 + 17;
+  let res = new Response('A'.repeat(size));
+  let text = await res.text();
+
+  assert(text.length, size, `(await res.text()).length`);
+  assert(
+    text === 'A'.repeat(size),
+    true,
+    `await res.text() === "A".repeat(size)`,
+  );
+});
+
+routes.set('/response/json/host-backed-large', async () => {
+  const items = Array.from({ length: 100_000 }, (_, i) => ({ i, s: 'x' + i }));
+  let res = new Response(JSON.stringify(items));
+  let json = await res.json();
+
+  assert(json.length, items.length, `(await res.json()).length`);
+  assert(json[99_999], items[99_999], `(await res.json())[99999]`);
+});
+
+routes.set('/response/arrayBuffer/host-backed-large', async () => {
+  const size = 2 * 1024 * 1024 + 3;
+  let res = new Response(new Uint8Array(size).fill(7));
+  let buffer = await res.arrayBuffer();
+
+  assert(buffer.byteLength, size, `(await res.arrayBuffer()).byteLength`);
+  assert(
+    new Uint8Array(buffer).every((byte) => byte === 7),
+    true,
+    `every byte of the ArrayBuffer is 7`,
+  );
+});
+
+// Counts the body read hostcalls made so far in the current request.
+function bodyReadCalls() {
+  const { hostcalls } = profile();
+  return (
+    (hostcalls['HttpBody::read']?.calls ?? 0) +
+    (hostcalls['HttpBody::read_into']?.calls ?? 0)
+  );
+}
+
+// Reads a host-backed body stream to the end, returning the number of bytes
+// and chunks read, and the number of body read hostcalls made per MiB.
+async function readHostBackedStream(res, byte) {
+  enableProfiling(true);
+  try {
+    const readsBefore = bodyReadCalls();
+    let reader = res.body.getReader();
+    let total = 0;
+    let chunks = 0;
+    let largestChunk = 0;
+    // eslint-disable-next-line no-constant-condition
+    while (true) {
+      const { done, value } = await reader.read();
+      if (done) {
+        break;
+      }
+      if (!value.every((b) => b === byte)) {
+        throw new Error('Unexpected byte in host-backed body stream');
+      }
+      total += value.byteLength;
+      chunks++;
+      largestChunk = Math.max(largestChunk, value.byteLength);
+    }
+    const readsPerMiB =
+      (bodyReadCalls() - readsBefore) / (total / (1024 * 1024));
+    return { total, chunks, largestChunk, readsPerMiB };
+  } finally {
+    enableProfiling(false);
+  }
+}
+
+routes.set('/response/body/host-backed-large-stream', async () => {
+  const size = 3 * 1024 * 1024 + 17;
+  let res = new Response(new Uint8Array(size).fill(66));
+  const { total, chunks, readsPerMiB } = await readHostBackedStream(res, 66);
+
+  assert(total, size, `total bytes read`);
+  // A fixed 8KiB chunk size would need 385 reads for this body, 128 per MiB.
+  assert(chunks < 385, true, `chunks < 385 (got ${chunks})`);
+  assert(readsPerMiB < 8, true, `body reads per MiB < 8 (got ${readsPerMiB})`);
+  return new Response(`${readsPerMiB.toFixed(2)} body reads per MiB`);
+});
+
+routes.set('/response/body/max-chunk-size', async () => {
+  const size = 1024 * 1024;
+  let res = new Response(new Uint8Array(size).fill(67));
+  res.setMaxBodyChunkSize(16384);
+  const { total, largestChunk, readsPerMiB } = await readHostBackedStream(
+    res,
+    67,
+  );
+
+  assert(total, size, `total bytes read`);
+  assert(
+    largestChunk <= 16384,
+    true,
+    `largest chunk <= 16384 (got ${largestChunk})`,
+  );
+  assert(readsPerMiB >= 64, true, `body reads per MiB >= 64`);
+  return new Response(`${readsPerMiB.toFixed(2)} body reads per MiB`);
+});
+
+routes.set('/response/body/max-chunk-size/invalid', async () => {
+  let res = new Response('hello');
+  for (const size of [0, 8191, 1048577, 10000.5, NaN, 'big']) {
+    assertThrows(
+      () => res.setMaxBodyChunkSize(size),
+      RangeError,
+      'Response.setMaxBodyChunkSize: size must be an integer between 8192 and 1048576',
+    );
+  }
+  res.setMaxBodyChunkSize('65536');
+  assert(await res.text(), 'hello', `await res.text()`);
+});
+
 routes.set('/response/json/guest-backed-stream', async () => {
   let obj = { a: 1, b: 2, c: { d: 3 } };
   let encoder = new TextEncoder();
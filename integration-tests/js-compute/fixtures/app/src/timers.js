@@ -360,6 +360,57 @@ import { CacheOverride } from 'fastly:cache-override';
     const secondValue = await second;
     assert(secondValue.status, 504, 'should get second value timeout');
   });
+  // Thousands of pending timers, many of which are due at the same time, all fire and none fires
+  // early. Also serves as a benchmark for the event loop's timer handling: the time taken is
+  // logged.
+  routes.set('/setTimeout/many-timers', async () => {
+    const count = 5000;
+    const start = performance.now();
+    let fired = 0;
+    await new Promise((resolve, reject) => {
+      for (let i = 0; i < count; i++) {
+        const delay = (i * 7) % 20;
+        const scheduled = performance.now();
+        setTimeout(() => {
+          if (performance.now() - scheduled < delay) {
+            reject(new Error(`Timer with delay ${delay} fired early`));
+          }
+          if (++fired === count) {
+            resolve();
+          }
+        }, delay);
+      }
+    });
+    console.log(`${count} timers fired in ${performance.now() - start}ms`);
+    assert(fired, count, 'fired');
+  });
+  // Timers that are cleared or re-armed while many others are pending.
+  routes.set('/setTimeout/many-timers-cleared', async () => {
+    const fired = [];
+    const timers = [];
+    for (let i = 0; i < 1000; i++) {
+      timers.push(setTimeout(() => fired.push(i), i % 10));
+    }
+    for (let i = 1; i < timers.length; i += 2) {
+      clearTimeout(timers[i]);
+    }
+    let ticks = 0;
+    await new Promise((resolve) => {
+      const interval = setInterval(() => {
+        if (++ticks === 5) {
+          clearInterval(interval);
+          setTimeout(resolve, 20);
+        }
+      }, 1);
+    });
+    assert(ticks, 5, 'ticks');
+    assert(fired.length, 500, 'fired.length');
+    assert(
+      fired.every((i) => i % 2 === 0),
+      true,
+      'only uncleared timers fired',
+    );
+  });
 }
 
 // clearInterval
@@ -97,3 +97,67 @@ routes.set('/acl', async () => {
     prefix: '2a03:4b80:0000:0000:0000:0000:0000:0000/32',
   });
 });
+
+routes.set('/acl/octets', async () => {
+  const acl = Acl.open(ACL_NAME);
+
+  await assertRejects(
+    () => acl.lookup(new Uint8Array([100, 100, 100])),
+    Error,
+    'Invalid address passed to acl.lookup',
+  );
+  strictEqual(await acl.lookup(new Uint8Array([123, 123, 123, 123])), null);
+  deepStrictEqual(await acl.lookup(new Uint8Array([100, 100, 100, 100])), {
+    action: 'BLOCK',
+    prefix: '100.100.0.0/16',
+  });
+  const ipv6 = new Uint8Array(16);
+  ipv6.set([0x2a, 0x03, 0x4b, 0x80]);
+  ipv6[15] = 1;
+  deepStrictEqual(await acl.lookup(ipv6.buffer), {
+    action: 'ALLOW',
+    prefix: '2a03:4b80:0000:0000:0000:0000:0000:0000/32',
+  });
+});
+
+routes.set('/acl/cache', async () => {
+  assertThrows(() => Acl.enableCache('big'), TypeError);
+  assertThrows(() => Acl.enableCache({ maxEntries: 0 }), RangeError);
+  assertThrows(() => Acl.enableCache({ maxAge: -1 }), RangeError);
+
+  const acl = Acl.open(ACL_NAME);
+  Acl.enableCache({ maxEntries: 2, maxAge: 60000 });
+  try {
+    const before = Acl.cacheStats();
+    const match = { action: 'BLOCK', prefix: '100.100.0.0/16' };
+    deepStrictEqual(await acl.lookup('100.100.100.100'), match, 'first lookup');
+    deepStrictEqual(
+      await acl.lookup(new Uint8Array([100, 100, 100, 100])),
+      match,
+      'cached lookup',
+    );
+    strictEqual(await acl.lookup('123.123.123.123'), null, 'no match');
+    strictEqual(await acl.lookup('123.123.123.123'), null, 'cached no match');
+    let stats = Acl.cacheStats();
+    strictEqual(stats.misses - before.misses, 2, 'cacheStats().misses');
+    strictEqual(stats.hits - before.hits, 2, 'cacheStats().hits');
+    strictEqual(stats.entries, 2, 'cacheStats().entries');
+
+    // Each lookup returns a new object, so callers can't alter cached results.
+    const result = await acl.lookup('100.100.100.100');
+    result.action = 'ALLOW';
+    deepStrictEqual(await acl.lookup('100.100.100.100'), match, 'after edit');
+
+    strictEqual(await acl.lookup('100.99.100.100'), null, 'third address');
+    stats = Acl.cacheStats();
+    strictEqual(stats.entries, 2, 'cacheStats().entries after eviction');
+    strictEqual(
+      stats.evictions - before.evictions,
+      1,
+      'cacheStats().evictions',
+    );
+  } finally {
+    Acl.disableCache();
+  }
+  strictEqual(Acl.cacheStats().entries, 0, 'disableCache() clears entries');
+});
@@ -8,7 +8,7 @@ import {
 } from './assertions.js';
 import { KVStore } from 'fastly:kv-store';
 import { routes, isRunningLocally } from './routes.js';
-import { sdkVersion } from 'fastly:experimental';
+import { enableProfiling, profile, sdkVersion } from 'fastly:experimental';
 import { env } from 'fastly:env';
 
 const KV_STORE_NAME = env('KV_STORE_NAME');
@@ -1338,6 +1338,56 @@ const debug = sdkVersion.endsWith('-debug');
       );
     });
   }
+
+  // KVStore getMany method
+  {
+    routes.set('/kv-store/get-many/invalid-arguments', async () => {
+      let store = new KVStore(KV_STORE_NAME);
+      await assertRejects(() => store.getMany('key'), TypeError);
+      await assertRejects(() => store.getMany(['a', '']), TypeError);
+      await assertRejects(() => store.getMany(['a', '..']), TypeError);
+      await assertRejects(
+        () => store.getMany(['a'], { concurrency: 0 }),
+        TypeError,
+      );
+      await assertRejects(
+        () => store.getMany(['a'], { concurrency: 1.5 }),
+        TypeError,
+      );
+    });
+
+    routes.set('/kv-store/get-many/entries', async () => {
+      let store = new KVStore(KV_STORE_NAME);
+      let keys = [];
+      for (let i = 0; i < 5; i++) {
+        let key = `get-many-${i}-${Math.random()}`;
+        await store.put(key, `hello${i}`);
+        keys.push(key);
+      }
+      let missing = `get-many-missing-${Math.random()}`;
+
+      for (const options of [undefined, { concurrency: 2 }]) {
+        let results = await store.getMany([...keys, missing, keys[0]], options);
+        strictEqual(results instanceof Map, true, `results instanceof Map`);
+        deepStrictEqual(
+          [...results.keys()],
+          [...keys, missing],
+          `[...results.keys()]`,
+        );
+        for (let i = 0; i < keys.length; i++) {
+          strictEqual(
+            await results.get(keys[i]).text(),
+            `hello${i}`,
+            `await results.get(keys[${i}]).text()`,
+          );
+        }
+        strictEqual(results.get(missing), null, `results.get(missing)`);
+      }
+
+      let empty = await store.getMany([]);
+      strictEqual(empty.size, 0, `(await store.getMany([])).size`);
+    });
+  }
 }
 
 // KVStoreEntry
@@ -1773,7 +1823,14 @@ async function kvStoreEntryInterfaceTests() {
 
 async function kvStoreInterfaceTests() {
   let actual = Reflect.ownKeys(KVStore);
-  let expected = ['prototype', 'length', 'name'];
+  let expected = [
+    'prototype',
+    'enableCache',
+    'disableCache',
+    'cacheStats',
+    'length',
+    'name',
+  ];
   deepStrictEqual(actual, expected, `Reflect.ownKeys(KVStore)`);
 
   actual = Reflect.getOwnPropertyDescriptor(KVStore, 'prototype');
@@ -1816,7 +1873,15 @@ async function kvStoreInterfaceTests() {
   );
 
   actual = Reflect.ownKeys(KVStore.prototype);
-  expected = ['constructor', 'delete', 'get', 'put', 'list'];
+  expected = [
+    'constructor',
+    'delete',
+    'get',
+    'getMany',
+    'put',
+    'list',
+    'listAll',
+  ];
   deepStrictEqual(actual, expected, `Reflect.ownKeys(KVStore.prototype)`);
 
   actual = Reflect.getOwnPropertyDescriptor(KVStore.prototype, 'constructor');
@@ -2021,6 +2086,118 @@ routes.set('/kv-store/list/large-response', async () => {
   return new Response('ok');
 });
 
+// The number of KV store and body hostcalls made while profiling.
+function kvAndBodyHostcalls() {
+  return Object.entries(profile().hostcalls)
+    .filter(
+      ([name]) => name.startsWith('KVStore') || name.startsWith('HttpBody'),
+    )
+    .reduce((total, [, { calls }]) => total + calls, 0);
+}
+
+routes.set('/kv-store/cache', async () => {
+  assertThrows(() => KVStore.enableCache('big'), TypeError);
+  assertThrows(() => KVStore.enableCache({ maxBytes: 0 }), RangeError);
+  assertThrows(() => KVStore.enableCache({ maxAge: -1 }), RangeError);
+
+  const store = new KVStore(KV_STORE_NAME);
+  const key = `cache-${Math.random()}`;
+  await store.put(key, 'cached', { metadata: 'meta' });
+
+  KVStore.enableCache({ maxBytes: 1024 * 1024, maxAge: 60000 });
+  try {
+    const before = KVStore.cacheStats();
+    strictEqual(await (await store.get(key)).text(), 'cached', 'first get');
+    // A hit is served from memory, without any KV store or body hostcalls.
+    enableProfiling(true);
+    let entry;
+    try {
+      const calls = kvAndBodyHostcalls();
+      entry = await store.get(key);
+      strictEqual(await entry.text(), 'cached', 'cached get');
+      strictEqual(kvAndBodyHostcalls() - calls, 0, 'hostcalls for a hit');
+    } finally {
+      enableProfiling(false);
+    }
+    strictEqual(entry.metadataText(), 'meta', 'cached metadataText()');
+    strictEqual(
+      await new Response((await store.get(key)).body).text(),
+      'cached',
+      'cached get body',
+    );
+    let stats = KVStore.cacheStats();
+    strictEqual(stats.misses - before.misses, 1, 'cacheStats().misses');
+    strictEqual(stats.hits - before.hits, 2, 'cacheStats().hits');
+    strictEqual(stats.entries >= 1, true, 'cacheStats().entries');
+
+    // Writes through this sandbox invalidate the cached value.
+    await store.put(key, 'updated');
+    strictEqual(await (await store.get(key)).text(), 'updated', 'get after put');
+    await store.delete(key);
+    strictEqual(await store.get(key), null, 'get after delete');
+
+    // A lookup that was in flight during a write doesn't cache what it found.
+    const raceKey = `${key}-race`;
+    await store.put(raceKey, 'before');
+    const lookup = store.get(raceKey);
+    await store.put(raceKey, 'after');
+    await lookup;
+    strictEqual(
+      await (await store.get(raceKey)).text(),
+      'after',
+      'get after a put during a lookup',
+    );
+    await store.delete(raceKey);
+  } finally {
+    KVStore.disableCache();
+  }
+  strictEqual(KVStore.cacheStats().entries, 0, 'disableCache() clears entries');
+  return new Response('ok');
+});
+
+routes.set('/kv-store/list-all', async () => {
+  const store = new KVStore(KV_STORE_NAME);
+  assertThrows(() => store.listAll('prefix'), TypeError);
+  assertThrows(() => store.listAll({ pageSize: 0 }), TypeError);
+  assertThrows(() => store.listAll({ prefix: 5 }), TypeError);
+
+  const prefix = `list-all-${Math.random()}-`;
+  const expected = Array.from(
+    { length: 25 },
+    (_, i) => prefix + String(i).padStart(2, '0'),
+  );
+  await Promise.all(expected.map((key) => store.put(key, 'x')));
+
+  const iterator = store.listAll({ prefix, pageSize: 10 });
+  strictEqual(
+    iterator[Symbol.asyncIterator](),
+    iterator,
+    'iterator[Symbol.asyncIterator]() === iterator',
+  );
+  const keys = [];
+  for await (const key of iterator) {
+    keys.push(key);
+  }
+  deepStrictEqual(keys, expected, 'keys yielded by listAll()');
+  deepStrictEqual(
+    await iterator.next(),
+    { value: undefined, done: true },
+    'iterator.next() after the last key',
+  );
+
+  // Calls to next() that overlap still yield each key once, in order.
+  const overlapping = store.listAll({ prefix, pageSize: 10 });
+  const results = await Promise.all(
+    expected.map(() => overlapping.next()),
+  );
+  deepStrictEqual(
+    results.map(({ value }) => value),
+    expected,
+    'keys yielded by overlapping next() calls',
+  );
+  return new Response('ok');
+});
+
 function iteratableToStream(iterable) {
   return new ReadableStream({
     async pull(controller) {
@@ -1,11 +1,19 @@
 #include "acl.h"
+#include "../common/lru_cache.h"
 #include "../common/validations.h"
 #include "../host-api/host_api_fastly.h"
 #include "builtin.h"
 #include "encode.h"
 #include "fastly.h"
+#include "js/ArrayBuffer.h"
 #include "js/JSON.h"
+#include "js/experimental/TypedData.h"
+#include <algorithm>
 #include <arpa/inet.h>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
 
 using builtins::BuiltinNoConstructor;
 using fastly::FastlyGetErrorMessage;
@@ -33,6 +41,192 @@ host_api::HostString parse_and_validate_name(JSContext *cx, JS::HandleValue name
   }
   return core::encode(cx, name);
 }
+
+constexpr size_t DEFAULT_ACL_CACHE_MAX_ENTRIES = 1024;
+constexpr uint64_t DEFAULT_ACL_CACHE_MAX_AGE_NS = 60ull * 1000 * 1000 * 1000;
+
+// A matching ACL entry, as returned by the host.
+struct AclMatch {
+  std::string action;
+  std::string prefix;
+};
+
+// A lookup result kept by the opt-in cache, see `Acl.enableCache`. Misses are cached too.
+struct AclCacheEntry {
+  std::optional<AclMatch> match;
+  uint64_t fresh_until;
+
+  AclCacheEntry(std::optional<AclMatch> match, uint64_t fresh_until)
+      : match(std::move(match)), fresh_until(fresh_until) {}
+};
+
+// Shared by every request handled by a reusable sandbox, like the `KVStore` lookup cache.
+struct AclCacheState {
+  bool enabled = false;
+  uint64_t max_age_ns = 0;
+  common::LruCache<AclCacheEntry> entries;
+  std::vector<std::string> acl_names;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+};
+
+AclCacheState acl_cache;
+
+uint32_t acl_cache_acl_id(std::string_view acl_name) {
+  auto &names = acl_cache.acl_names;
+  auto found = std::find(names.begin(), names.end(), acl_name);
+  if (found != names.end()) {
+    return found - names.begin();
+  }
+  names.emplace_back(acl_name);
+  return names.size() - 1;
+}
+
+std::string acl_cache_key(JSObject *acl, std::span<uint8_t> octets) {
+  uint32_t acl_id =
+      JS::GetReservedSlot(acl, static_cast<uint32_t>(Acl::Slots::CacheAclId)).toInt32();
+  std::string cache_key(reinterpret_cast<const char *>(&acl_id), sizeof(acl_id));
+  cache_key.append(reinterpret_cast<const char *>(octets.data()), octets.size());
+  return cache_key;
+}
+
+void acl_cache_insert(std::string cache_key, std::optional<AclMatch> match) {
+  auto fresh_until = host_api::MonotonicClock::now() + acl_cache.max_age_ns;
+  acl_cache.entries.insert(std::move(cache_key), std::move(match), fresh_until);
+}
+
+// Fills `octets` with the address given to `lookup`, which is either a string or the raw octets
+// in an ArrayBuffer or view, such as `event.client.addressOctets`. Sets `octets_len` to 0 if the
+// address isn't valid.
+bool address_octets(JSContext *cx, JS::HandleValue address_val, uint8_t *octets,
+                    size_t *octets_len) {
+  *octets_len = 0;
+  if (address_val.isObject()) {
+    JSObject *obj = &address_val.toObject();
+    if (JS_IsArrayBufferViewObject(obj) || JS::IsArrayBufferObject(obj)) {
+      JS::AutoCheckCannotGC noGC(cx);
+      bool is_shared;
+      size_t length;
+      uint8_t *data;
+      if (JS_IsArrayBufferViewObject(obj)) {
+        length = JS_GetArrayBufferViewByteLength(obj);
+        data = static_cast<uint8_t *>(JS_GetArrayBufferViewData(obj, &is_shared, noGC));
+      } else {
+        JS::GetArrayBufferLengthAndData(obj, &length, &is_shared, &data);
+      }
+      if (length == 4 || length == 16) {
+        std::memcpy(octets, data, length);
+        *octets_len = length;
+      }
+      return true;
+    }
+  }
+
+  JS::RootedString address_str(cx, JS::ToString(cx, address_val));
+  if (!address_str)
+    return false;
+
+  auto address = core::encode(cx, address_str);
+  if (!address) {
+    return false;
+  }
+
+  int format = AF_INET;
+  size_t len = 4;
+  if (std::find(address.begin(), address.end(), ':') != address.end()) {
+    format = AF_INET6;
+    len = 16;
+  }
+
+  if (inet_pton(format, address.begin(), octets) == 1) {
+    *octets_len = len;
+  }
+  return true;
+}
+
+// Decodes the `{"action": "...", "prefix": "..."}` object the host returns for a match, without
+// going through a JS string and the JSON parser. Returns false for anything else, including
+// escaped characters, which none of the expected values contain.
+bool decode_match(std::string_view json, AclMatch *match) {
+  size_t pos = 0;
+  auto skip_whitespace = [&] {
+    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' ||
+                                 json[pos] == '\r')) {
+      pos++;
+    }
+  };
+  auto consume = [&](char c) {
+    skip_whitespace();
+    if (pos < json.size() && json[pos] == c) {
+      pos++;
+      return true;
+    }
+    return false;
+  };
+  auto read_string = [&](std::string_view *out) {
+    if (!consume('"')) {
+      return false;
+    }
+    auto end = json.find_first_of("\"\\", pos);
+    if (end == std::string_view::npos || json[end] != '"') {
+      return false;
+    }
+    *out = json.substr(pos, end - pos);
+    pos = end + 1;
+    return true;
+  };
+
+  bool has_action = false;
+  bool has_prefix = false;
+  if (!consume('{')) {
+    return false;
+  }
+  do {
+    std::string_view key;
+    std::string_view value;
+    if (!read_string(&key) || !consume(':') || !read_string(&value)) {
+      return false;
+    }
+    if (key == "action" && !has_action) {
+      match->action = value;
+      has_action = true;
+    } else if (key == "prefix" && !has_prefix) {
+      match->prefix = value;
+      has_prefix = true;
+    } else {
+      return false;
+    }
+  } while (consume(','));
+  if (!consume('}')) {
+    return false;
+  }
+  skip_whitespace();
+  return pos == json.size() && has_action && has_prefix;
+}
+
+// Creates the object returned by `lookup`. The properties are always defined in the same order,
+// so all results share a single shape.
+bool create_match(JSContext *cx, const std::optional<AclMatch> &match,
+                  JS::MutableHandleValue rval) {
+  if (!match) {
+    rval.setNull();
+    return true;
+  }
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+  JS::RootedString action(cx, JS_NewStringCopyN(cx, match->action.data(), match->action.size()));
+  if (!action || !JS_DefineProperty(cx, result, "action", action, JSPROP_ENUMERATE)) {
+    return false;
+  }
+  JS::RootedString prefix(cx, JS_NewStringCopyN(cx, match->prefix.data(), match->prefix.size()));
+  if (!prefix || !JS_DefineProperty(cx, result, "prefix", prefix, JSPROP_ENUMERATE)) {
+    return false;
+  }
+  rval.setObject(*result);
+  return true;
+}
 } // namespace
 
 bool Acl::open(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -65,6 +259,8 @@ bool Acl::open(JSContext *cx, unsigned argc, JS::Value *vp) {
 
   JS::SetReservedSlot(acl_instance, static_cast<uint32_t>(Slots::HostAcl),
                       JS::Int32Value(found.value().handle));
+  JS::SetReservedSlot(acl_instance, static_cast<uint32_t>(Slots::CacheAclId),
+                      JS::Int32Value(acl_cache_acl_id(name)));
 
   args.rval().setObject(*acl_instance);
   return true;
@@ -73,28 +269,27 @@ bool Acl::open(JSContext *cx, unsigned argc, JS::Value *vp) {
 bool Acl::lookup(JSContext *cx, unsigned argc, JS::Value *vp) {
   METHOD_HEADER(1)
 
-  JS::RootedString address_str(cx, JS::ToString(cx, args[0]));
-  if (!address_str)
-    return false;
-
-  auto address = core::encode(cx, address_str);
-  if (!address) {
+  uint8_t octets[sizeof(struct in6_addr)];
+  size_t octets_len = 0;
+  if (!address_octets(cx, args[0], octets, &octets_len)) {
     return false;
   }
-
-  int format = AF_INET;
-  size_t octets_len = 4;
-  if (std::find(address.begin(), address.end(), ':') != address.end()) {
-    format = AF_INET6;
-    octets_len = 16;
-  }
-
-  uint8_t octets[sizeof(struct in6_addr)];
-  if (inet_pton(format, address.begin(), octets) != 1) {
+  if (octets_len == 0) {
     JS_ReportErrorLatin1(cx, "Invalid address passed to acl.lookup");
     return false;
   }
 
+  std::string cache_key;
+  if (acl_cache.enabled) {
+    cache_key = acl_cache_key(self, std::span<uint8_t>{octets, octets_len});
+    auto *cached = acl_cache.entries.find(cache_key);
+    if (cached && host_api::MonotonicClock::now() < cached->fresh_until) {
+      acl_cache.hits++;
+      return create_match(cx, cached->match, args.rval());
+    }
+    acl_cache.misses++;
+  }
+
   host_api::Acl acl{static_cast<host_api::Acl::Handle>(
       JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::HostAcl)).toInt32())};
   auto lookup_res = acl.lookup(std::span<uint8_t>{octets, octets_len});
@@ -109,6 +304,9 @@ bool Acl::lookup(JSContext *cx, unsigned argc, JS::Value *vp) {
   case host_api::Acl::LookupError::Ok:
     break;
   case host_api::Acl::LookupError::NoContent:
+    if (acl_cache.enabled) {
+      acl_cache_insert(std::move(cache_key), std::nullopt);
+    }
     args.rval().setNull();
     return true;
   case host_api::Acl::LookupError::TooManyRequests:
@@ -124,26 +322,92 @@ bool Acl::lookup(JSContext *cx, unsigned argc, JS::Value *vp) {
     HANDLE_ERROR(cx, *err);
     return false;
   }
+  auto &buf = buf_res.unwrap();
+  std::string_view json{reinterpret_cast<char *>(buf.ptr.get()), buf.len};
+
+  AclMatch match;
+  if (decode_match(json, &match)) {
+    if (!create_match(cx, match, args.rval())) {
+      return false;
+    }
+    if (acl_cache.enabled) {
+      acl_cache_insert(std::move(cache_key), std::move(match));
+    }
+    return true;
+  }
 
-  JS::RootedString str(
-      cx,
-      JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(reinterpret_cast<char *>(buf_res.unwrap().ptr.get()),
-                                              buf_res.unwrap().len)));
+  // Anything but the plain `{"action": ..., "prefix": ...}` object is handed to the full JSON
+  // parser, and isn't cached.
+  JS::RootedString str(cx, JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(json.data(), json.size())));
   if (!str) {
     return false;
   }
 
-  JS::RootedValue json(cx);
-  if (!JS_ParseJSON(cx, str, &json)) {
+  JS::RootedValue result(cx);
+  if (!JS_ParseJSON(cx, str, &result)) {
+    return false;
+  }
+
+  args.rval().set(result);
+  return true;
+}
+
+bool Acl::enableCache(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  size_t max_entries = DEFAULT_ACL_CACHE_MAX_ENTRIES;
+  uint64_t max_age_ns = DEFAULT_ACL_CACHE_MAX_AGE_NS;
+
+  JS::RootedObject options(cx);
+  if (!common::cache_options(cx, args.get(0), "Acl.enableCache", &options) ||
+      !common::cache_limit_option(cx, options, "Acl.enableCache", "maxEntries", &max_entries) ||
+      !common::cache_age_option(cx, options, "Acl.enableCache", "maxAge", &max_age_ns)) {
     return false;
   }
 
-  args.rval().set(json);
+  acl_cache.entries.reset(max_entries);
+  acl_cache.enabled = true;
+  acl_cache.max_age_ns = max_age_ns;
+  args.rval().setUndefined();
+  return true;
+}
+
+bool Acl::disableCache(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  acl_cache.entries.clear();
+  acl_cache.enabled = false;
+  args.rval().setUndefined();
+  return true;
+}
+
+bool Acl::cacheStats(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+  std::pair<const char *, double> stats[] = {
+      {"hits", static_cast<double>(acl_cache.hits)},
+      {"misses", static_cast<double>(acl_cache.misses)},
+      {"evictions", static_cast<double>(acl_cache.entries.evictions())},
+      {"entries", static_cast<double>(acl_cache.entries.size())},
+  };
+  JS::RootedValue val(cx);
+  for (auto [name, value] : stats) {
+    val.setNumber(value);
+    if (!JS_DefineProperty(cx, result, name, val, JSPROP_ENUMERATE)) {
+      return false;
+    }
+  }
+  args.rval().setObject(*result);
   return true;
 }
 
 const JSFunctionSpec Acl::static_methods[] = {
     JS_FN("open", Acl::open, 1, JSPROP_ENUMERATE),
+    JS_FN("enableCache", Acl::enableCache, 0, JSPROP_ENUMERATE),
+    JS_FN("disableCache", Acl::disableCache, 0, JSPROP_ENUMERATE),
+    JS_FN("cacheStats", Acl::cacheStats, 0, JSPROP_ENUMERATE),
+    JS_FS_END,
 };
 const JSPropertySpec Acl::static_properties[] = {JS_PS_END};
 const JSFunctionSpec Acl::methods[] = {JS_FN("lookup", Acl::lookup, 1, JSPROP_ENUMERATE),
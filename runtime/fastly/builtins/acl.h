@@ -11,7 +11,7 @@ private:
 public:
   static constexpr const char *class_name = "Acl";
   static const int ctor_length = 1;
-  enum Slots { HostAcl, Count };
+  enum Slots { HostAcl, CacheAclId, Count };
 
   static const JSFunctionSpec static_methods[];
   static const JSPropertySpec static_properties[];
@@ -20,6 +20,9 @@ public:
   static const JSPropertySpec properties[];
 
   static bool open(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool enableCache(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool disableCache(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool cacheStats(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool lookup(JSContext *cx, unsigned argc, JS::Value *vp);
 };
 
@@ -1,13 +1,207 @@
 #include "config-store.h"
 #include "../../../StarlingMonkey/runtime/encode.h"
+#include "../common/lru_cache.h"
 #include "../host-api/host_api_fastly.h"
 #include "fastly.h"
+#include "js/Array.h"
+
+#include <algorithm>
 
 using builtins::BuiltinImpl;
 using fastly::FastlyGetErrorMessage;
 
 namespace fastly::config_store {
 
+namespace {
+
+constexpr uint64_t DEFAULT_CACHE_TTL_NS = 60ull * 1000 * 1000 * 1000;
+constexpr size_t DEFAULT_CACHE_MAX_ENTRIES = 1000;
+
+struct ConfigCacheEntry {
+  JS::PersistentRooted<JS::Value> value;
+  uint64_t expires_at;
+
+  ConfigCacheEntry(JSContext *cx, JS::HandleValue value, uint64_t expires_at)
+      : value(cx, value), expires_at(expires_at) {}
+};
+
+struct ConfigCacheState {
+  bool enabled = false;
+  uint64_t ttl_ns = 0;
+  common::LruCache<ConfigCacheEntry> entries;
+  std::vector<std::string> store_names;
+  ConfigCache::Stats stats;
+};
+
+ConfigCacheState config_cache;
+
+std::string cache_key(uint32_t store_id, std::string_view key) {
+  std::string cache_key(reinterpret_cast<const char *>(&store_id), sizeof(store_id));
+  cache_key.append(key);
+  return cache_key;
+}
+
+} // namespace
+
+bool ConfigCache::enabled() { return config_cache.enabled; }
+
+void ConfigCache::enable(uint64_t ttl_ns, size_t max_entries) {
+  config_cache.entries.reset(max_entries);
+  config_cache.enabled = true;
+  config_cache.ttl_ns = ttl_ns;
+}
+
+void ConfigCache::disable() {
+  config_cache.entries.clear();
+  config_cache.enabled = false;
+}
+
+ConfigCache::Stats ConfigCache::stats() {
+  auto stats = config_cache.stats;
+  stats.size = config_cache.entries.size();
+  return stats;
+}
+
+uint32_t ConfigCache::store_id(std::string_view store_name) {
+  auto &names = config_cache.store_names;
+  auto found = std::find(names.begin(), names.end(), store_name);
+  if (found != names.end()) {
+    return found - names.begin();
+  }
+  names.emplace_back(store_name);
+  return names.size() - 1;
+}
+
+bool ConfigCache::lookup(uint32_t store_id, std::string_view key, JS::MutableHandleValue out) {
+  if (!config_cache.enabled) {
+    return false;
+  }
+  auto entry_key = cache_key(store_id, key);
+  auto *entry = config_cache.entries.find(entry_key);
+  if (!entry) {
+    config_cache.stats.misses++;
+    return false;
+  }
+  if (host_api::MonotonicClock::now() >= entry->expires_at) {
+    config_cache.entries.erase(entry_key);
+    config_cache.stats.misses++;
+    return false;
+  }
+  config_cache.stats.hits++;
+  out.set(entry->value);
+  return true;
+}
+
+void ConfigCache::insert(JSContext *cx, uint32_t store_id, std::string_view key,
+                         JS::HandleValue value) {
+  if (!config_cache.enabled) {
+    return;
+  }
+  auto expires_at = host_api::MonotonicClock::now() + config_cache.ttl_ns;
+  config_cache.entries.insert(cache_key(store_id, key), cx, value, expires_at);
+}
+
+bool get_many(JSContext *cx, JS::HandleValue keys_val, uint32_t store_id, const KeyErrors &errors,
+              const ConfigFetcher &fetch, JS::MutableHandleValue rval) {
+  bool is_array = false;
+  if (!JS::IsArrayObject(cx, keys_val, &is_array)) {
+    return false;
+  }
+  if (!is_array) {
+    JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr, errors.not_array);
+    return false;
+  }
+
+  JS::RootedObject keys_array(cx, &keys_val.toObject());
+  uint32_t length = 0;
+  if (!JS::GetArrayLength(cx, keys_array, &length)) {
+    return false;
+  }
+
+  // Validate every key before doing any lookups.
+  std::vector<host_api::HostString> keys;
+  keys.reserve(length);
+  JS::RootedValue key_val(cx);
+  for (uint32_t i = 0; i < length; i++) {
+    if (!JS_GetElement(cx, keys_array, i, &key_val)) {
+      return false;
+    }
+    auto key = core::encode(cx, key_val);
+    if (!key) {
+      return false;
+    }
+    if (key.len == 0) {
+      JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr, errors.empty);
+      return false;
+    }
+    if (key.len > 255) {
+      JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr, errors.too_long);
+      return false;
+    }
+    keys.push_back(std::move(key));
+  }
+
+  // Answer what we can from the cache, and fetch the rest with a single call.
+  JS::RootedValueVector values(cx);
+  if (!values.resize(length)) {
+    JS_ReportOutOfMemory(cx);
+    return false;
+  }
+  std::vector<std::string_view> missing;
+  std::vector<uint32_t> missing_indices;
+  for (uint32_t i = 0; i < length; i++) {
+    std::string_view key = keys[i];
+    if (!ConfigCache::lookup(store_id, key, values[i])) {
+      missing.push_back(key);
+      missing_indices.push_back(i);
+    }
+  }
+
+  if (!missing.empty()) {
+    bool ok = true;
+    JS::RootedValue value(cx);
+    auto res = fetch(missing, [&](size_t i, std::optional<std::string_view> found) {
+      if (!found.has_value()) {
+        value.setNull();
+      } else {
+        JSString *text = JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(found->data(), found->size()));
+        if (!text) {
+          ok = false;
+          return false;
+        }
+        value.setString(text);
+      }
+      ConfigCache::insert(cx, store_id, missing[i], value);
+      values[missing_indices[i]].set(value);
+      return true;
+    });
+    if (auto *err = res.to_err()) {
+      HANDLE_ERROR(cx, *err);
+      return false;
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+  JS::RootedString name(cx);
+  JS::RootedId id(cx);
+  for (uint32_t i = 0; i < length; i++) {
+    name = JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(keys[i].ptr.get(), keys[i].len));
+    if (!name || !JS_StringToId(cx, name, &id) ||
+        !JS_DefinePropertyById(cx, result, id, values[i], JSPROP_ENUMERATE)) {
+      return false;
+    }
+  }
+
+  rval.setObject(*result);
+  return true;
+}
+
 host_api::ConfigStore ConfigStore::config_store_handle(JSObject *obj) {
   JS::Value val = JS::GetReservedSlot(obj, ConfigStore::Slots::Handle);
   return host_api::ConfigStore(val.toInt32());
@@ -31,6 +225,11 @@ bool ConfigStore::get(JSContext *cx, unsigned argc, JS::Value *vp) {
   }
 
   std::string_view key_str = key;
+  auto store_id = JS::GetReservedSlot(self, ConfigStore::Slots::CacheStoreId).toInt32();
+  if (ConfigCache::lookup(store_id, key_str, args.rval())) {
+    return true;
+  }
+
   // Ensure that we throw an exception for all unexpected host errors.
   auto get_res = ConfigStore::config_store_handle(self).get(key_str);
   if (auto *err = get_res.to_err()) {
@@ -42,19 +241,82 @@ bool ConfigStore::get(JSContext *cx, unsigned argc, JS::Value *vp) {
   auto ret = std::move(get_res.unwrap());
   if (!ret.has_value()) {
     args.rval().setNull();
-    return true;
+  } else {
+    JS::RootedString text(cx,
+                          JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(ret->begin(), ret->size())));
+    if (!text) {
+      return false;
+    }
+    args.rval().setString(text);
   }
 
-  JS::RootedString text(cx, JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(ret->begin(), ret->size())));
-  if (!text) {
+  ConfigCache::insert(cx, store_id, key_str, args.rval());
+  return true;
+}
+
+bool ConfigStore::getMany(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(1)
+
+  auto store = ConfigStore::config_store_handle(self);
+  auto store_id = JS::GetReservedSlot(self, ConfigStore::Slots::CacheStoreId).toInt32();
+  KeyErrors errors{JSMSG_CONFIG_STORE_KEYS_NOT_ARRAY, JSMSG_CONFIG_STORE_KEY_EMPTY,
+                   JSMSG_CONFIG_STORE_KEY_TOO_LONG};
+  return get_many(
+      cx, args[0], store_id, errors,
+      [&](const std::vector<std::string_view> &keys, const host_api::ConfigValueVisitor &visit) {
+        return store.get_many(keys, visit);
+      },
+      args.rval());
+}
+
+bool ConfigStore::enableCache(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  uint64_t ttl_ns = DEFAULT_CACHE_TTL_NS;
+  size_t max_entries = DEFAULT_CACHE_MAX_ENTRIES;
+
+  JS::RootedObject options(cx);
+  if (!common::cache_options(cx, args.get(0), "ConfigStore.enableCache", &options) ||
+      !common::cache_age_option(cx, options, "ConfigStore.enableCache", "ttl", &ttl_ns) ||
+      !common::cache_limit_option(cx, options, "ConfigStore.enableCache", "maxEntries",
+                                  &max_entries)) {
     return false;
   }
 
-  args.rval().setString(text);
+  ConfigCache::enable(ttl_ns, max_entries);
+  args.rval().setUndefined();
+  return true;
+}
+
+bool ConfigStore::disableCache(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  ConfigCache::disable();
+  args.rval().setUndefined();
+  return true;
+}
+
+bool ConfigStore::cacheStats(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  auto stats = ConfigCache::stats();
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+  JS::RootedValue hits(cx, JS::NumberValue(static_cast<double>(stats.hits)));
+  JS::RootedValue misses(cx, JS::NumberValue(static_cast<double>(stats.misses)));
+  JS::RootedValue size(cx, JS::NumberValue(static_cast<double>(stats.size)));
+  if (!JS_DefineProperty(cx, result, "hits", hits, JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, result, "misses", misses, JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, result, "size", size, JSPROP_ENUMERATE)) {
+    return false;
+  }
+  args.rval().setObject(*result);
   return true;
 }
 
 const JSFunctionSpec ConfigStore::static_methods[] = {
+    JS_FN("enableCache", enableCache, 0, JSPROP_ENUMERATE),
+    JS_FN("disableCache", disableCache, 0, JSPROP_ENUMERATE),
+    JS_FN("cacheStats", cacheStats, 0, JSPROP_ENUMERATE),
     JS_FS_END,
 };
 
@@ -62,7 +324,11 @@ const JSPropertySpec ConfigStore::static_properties[] = {
     JS_PS_END,
 };
 
-const JSFunctionSpec ConfigStore::methods[] = {JS_FN("get", get, 1, JSPROP_ENUMERATE), JS_FS_END};
+const JSFunctionSpec ConfigStore::methods[] = {
+    JS_FN("get", get, 1, JSPROP_ENUMERATE),
+    JS_FN("getMany", getMany, 1, JSPROP_ENUMERATE),
+    JS_FS_END,
+};
 
 const JSPropertySpec ConfigStore::properties[] = {JS_PS_END};
 
@@ -119,6 +385,8 @@ bool ConfigStore::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
 
   JS::SetReservedSlot(config_store, ConfigStore::Slots::Handle,
                       JS::Int32Value(open_res.unwrap().handle));
+  JS::SetReservedSlot(config_store, ConfigStore::Slots::CacheStoreId,
+                      JS::Int32Value(ConfigCache::store_id(name)));
   if (!config_store)
     return false;
   args.rval().setObject(*config_store);
@@ -7,12 +7,57 @@
 
 namespace fastly::config_store {
 
+/// Opt-in cache of ConfigStore and Dictionary lookups, shared by every request handled by a
+/// reusable sandbox.
+///
+/// Entries are keyed by store name and key, and hold the JS string returned for the value (or null
+/// for a missing key), so repeated lookups return the same string without a hostcall. Entries
+/// expire after a configurable time, and the least recently used are evicted beyond a maximum
+/// number of entries.
+class ConfigCache final {
+public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t size = 0;
+  };
+
+  static bool enabled();
+  /// Enable the cache, discarding any cached entries.
+  static void enable(uint64_t ttl_ns, size_t max_entries);
+  static void disable();
+  static Stats stats();
+
+  /// An ID for the store of the given name, for use as part of cache keys.
+  static uint32_t store_id(std::string_view store_name);
+
+  /// Returns true, with `out` set to the cached value, if `key` is cached for the given store.
+  static bool lookup(uint32_t store_id, std::string_view key, JS::MutableHandleValue out);
+  static void insert(JSContext *cx, uint32_t store_id, std::string_view key, JS::HandleValue value);
+};
+
+/// The error numbers reported by `get_many` for invalid keys.
+struct KeyErrors {
+  unsigned not_array;
+  unsigned empty;
+  unsigned too_long;
+};
+
+using ConfigFetcher = std::function<host_api::Result<host_api::Void>(
+    const std::vector<std::string_view> &, const host_api::ConfigValueVisitor &)>;
+
+/// Implements `getMany` for both ConfigStore and Dictionary: validates the array of `keys`, answers
+/// what it can from the lookup cache, and calls `fetch` once for all of the remaining keys. The
+/// result is a plain object with a property for each key, holding its value or null.
+bool get_many(JSContext *cx, JS::HandleValue keys, uint32_t store_id, const KeyErrors &errors,
+              const ConfigFetcher &fetch, JS::MutableHandleValue rval);
+
 class ConfigStore : public builtins::BuiltinImpl<ConfigStore> {
 private:
 public:
   static constexpr const char *class_name = "ConfigStore";
   static const int ctor_length = 1;
-  enum Slots { Handle, Count };
+  enum Slots { Handle, CacheStoreId, Count };
 
   static const JSFunctionSpec static_methods[];
   static const JSPropertySpec static_properties[];
@@ -20,6 +65,10 @@ public:
   static const JSPropertySpec properties[];
 
   static bool get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool getMany(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool enableCache(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool disableCache(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool cacheStats(JSContext *cx, unsigned argc, JS::Value *vp);
 
   static host_api::ConfigStore config_store_handle(JSObject *obj);
   static bool constructor(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -1,5 +1,6 @@
 #include "device.h"
 #include "../../../StarlingMonkey/runtime/encode.h"
+#include "../common/lru_cache.h"
 #include "../host-api/host_api_fastly.h"
 #include "builtin.h"
 #include "js/JSON.h"
@@ -9,6 +10,53 @@ using builtins::BuiltinNoConstructor;
 namespace fastly::device {
 
 namespace {
+
+constexpr size_t LOOKUP_CACHE_MAX_ENTRIES = 256;
+
+// Results of `Device.lookup` by User-Agent: the frozen, parsed detection result, or null if the
+// User-Agent wasn't identified. Detection results only depend on the User-Agent, so these are kept
+// across the requests handled by a reusable sandbox.
+common::LruCache<JS::PersistentRooted<JS::Value>> lookup_cache(LOOKUP_CACHE_MAX_ENTRIES);
+uint64_t lookup_cache_hits = 0;
+uint64_t lookup_cache_misses = 0;
+
+// Looks up the detection result for `user_agent`, either from the cache or with a hostcall.
+bool lookup_device_info(JSContext *cx, std::string_view user_agent,
+                        JS::MutableHandleValue device_info) {
+  if (auto *cached = lookup_cache.find(user_agent)) {
+    lookup_cache_hits++;
+    device_info.set(*cached);
+    return true;
+  }
+  lookup_cache_misses++;
+
+  auto lookup_res = host_api::DeviceDetection::lookup(user_agent);
+  if (auto *err = lookup_res.to_err()) {
+    if (!host_api::error_is_optional_none(*err)) {
+      HANDLE_ERROR(cx, *err);
+      return false;
+    }
+    device_info.setNull();
+  } else {
+    auto result = std::move(lookup_res.unwrap());
+    JS::RootedString device_info_str(cx, JS_NewStringCopyN(cx, result.ptr.get(), result.len));
+    if (!device_info_str) {
+      return false;
+    }
+    if (!JS_ParseJSON(cx, device_info_str, device_info)) {
+      return false;
+    }
+    MOZ_ASSERT(device_info.isObject());
+    JS::RootedObject device_info_obj(cx, &device_info.toObject());
+    if (!JS_DeepFreezeObject(cx, device_info_obj)) {
+      return false;
+    }
+  }
+
+  lookup_cache.insert(std::string(user_agent), cx, device_info);
+  return true;
+}
+
 bool callbackCalled;
 bool write_json_to_buf(const char16_t *str, uint32_t strlen, void *out) {
   callbackCalled = true;
@@ -520,39 +568,43 @@ bool Device::lookup(JSContext *cx, unsigned argc, JS::Value *vp) {
     return false;
   }
 
-  auto lookup_res = host_api::DeviceDetection::lookup(key);
-  if (auto *err = lookup_res.to_err()) {
-    if (host_api::error_is_optional_none(*err)) {
-      args.rval().setNull();
-      return true;
-    }
-    HANDLE_ERROR(cx, *err);
-    return false;
-  }
-  auto result = std::move(lookup_res.unwrap());
-
-  JS::RootedString device_info_str(cx, JS_NewStringCopyN(cx, result.ptr.get(), result.len));
-  if (!device_info_str) {
-    return false;
-  }
-
   JS::RootedValue device_info(cx);
-
-  if (!JS_ParseJSON(cx, device_info_str, &device_info)) {
+  if (!lookup_device_info(cx, key, &device_info)) {
     return false;
   }
+  if (device_info.isNull()) {
+    args.rval().setNull();
+    return true;
+  }
 
-  MOZ_ASSERT(device_info.isObject());
-
-  JS::RootedObject device_info_obj(cx, device_info.toObjectOrNull());
+  JS::RootedObject device_info_obj(cx, &device_info.toObject());
 
   args.rval().setObjectOrNull(Device::create(cx, device_info_obj));
 
   return true;
 }
 
+bool Device::cacheStats(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+  JS::RootedValue hits(cx, JS::NumberValue(static_cast<double>(lookup_cache_hits)));
+  JS::RootedValue misses(cx, JS::NumberValue(static_cast<double>(lookup_cache_misses)));
+  JS::RootedValue size(cx, JS::NumberValue(static_cast<double>(lookup_cache.size())));
+  if (!JS_DefineProperty(cx, result, "hits", hits, JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, result, "misses", misses, JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, result, "size", size, JSPROP_ENUMERATE)) {
+    return false;
+  }
+  args.rval().setObject(*result);
+  return true;
+}
+
 const JSFunctionSpec Device::static_methods[] = {
     JS_FN("lookup", lookup, 1, JSPROP_ENUMERATE),
+    JS_FN("cacheStats", cacheStats, 0, JSPROP_ENUMERATE),
     JS_FS_END,
 };
 
@@ -49,6 +49,7 @@ public:
   static bool toJSON(JSContext *cx, unsigned argc, JS::Value *vp);
 
   static bool lookup(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool cacheStats(JSContext *cx, unsigned argc, JS::Value *vp);
 
   static JSObject *create(JSContext *cx, JS::HandleObject deviceInfo);
 
@@ -1,9 +1,11 @@
 #include "dictionary.h"
 #include "../../../StarlingMonkey/runtime/encode.h"
 #include "../host-api/host_api_fastly.h"
+#include "config-store.h"
 #include "fastly.h"
 
 using fastly::FastlyGetErrorMessage;
+using fastly::config_store::ConfigCache;
 
 namespace fastly::dictionary {
 
@@ -35,6 +37,12 @@ bool Dictionary::get(JSContext *cx, unsigned argc, JS::Value *vp) {
     return false;
   }
 
+  // Dictionaries share the opt-in lookup cache with config stores, see `ConfigStore.enableCache`.
+  auto store_id = JS::GetReservedSlot(self, Dictionary::Slots::CacheStoreId).toInt32();
+  if (ConfigCache::lookup(store_id, name, args.rval())) {
+    return true;
+  }
+
   // Ensure that we throw an exception for all unexpected host errors.
   auto res = Dictionary::dictionary_handle(self).get(name);
   if (auto *err = res.to_err()) {
@@ -45,17 +53,33 @@ bool Dictionary::get(JSContext *cx, unsigned argc, JS::Value *vp) {
   auto ret = std::move(res.unwrap());
   if (!ret.has_value()) {
     args.rval().setNull();
-    return true;
+  } else {
+    JS::RootedString text(cx,
+                          JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(ret->ptr.get(), ret->len)));
+    if (!text)
+      return false;
+    args.rval().setString(text);
   }
 
-  JS::RootedString text(cx, JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(ret->ptr.get(), ret->len)));
-  if (!text)
-    return false;
-
-  args.rval().setString(text);
+  ConfigCache::insert(cx, store_id, name, args.rval());
   return true;
 }
 
+bool Dictionary::getMany(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(1)
+
+  auto dict = Dictionary::dictionary_handle(self);
+  auto store_id = JS::GetReservedSlot(self, Dictionary::Slots::CacheStoreId).toInt32();
+  config_store::KeyErrors errors{JSMSG_DICTIONARY_KEYS_NOT_ARRAY, JSMSG_DICTIONARY_KEY_EMPTY,
+                                 JSMSG_DICTIONARY_KEY_TOO_LONG};
+  return config_store::get_many(
+      cx, args[0], store_id, errors,
+      [&](const std::vector<std::string_view> &keys, const host_api::ConfigValueVisitor &visit) {
+        return dict.get_many(keys, visit);
+      },
+      args.rval());
+}
+
 const JSFunctionSpec Dictionary::static_methods[] = {
     JS_FS_END,
 };
@@ -64,7 +88,11 @@ const JSPropertySpec Dictionary::static_properties[] = {
     JS_PS_END,
 };
 
-const JSFunctionSpec Dictionary::methods[] = {JS_FN("get", get, 1, JSPROP_ENUMERATE), JS_FS_END};
+const JSFunctionSpec Dictionary::methods[] = {
+    JS_FN("get", get, 1, JSPROP_ENUMERATE),
+    JS_FN("getMany", getMany, 1, JSPROP_ENUMERATE),
+    JS_FS_END,
+};
 
 const JSPropertySpec Dictionary::properties[] = {JS_PS_END};
 
@@ -130,6 +158,8 @@ bool Dictionary::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
 
   auto dict = res.unwrap();
   JS::SetReservedSlot(dictionary, Dictionary::Slots::Handle, JS::Int32Value(dict.handle));
+  JS::SetReservedSlot(dictionary, Dictionary::Slots::CacheStoreId,
+                      JS::Int32Value(ConfigCache::store_id(name_view)));
   if (!dictionary) {
     return false;
   }
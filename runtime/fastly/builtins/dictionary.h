@@ -12,13 +12,14 @@ private:
 public:
   static constexpr const char *class_name = "Dictionary";
   static const int ctor_length = 1;
-  enum Slots { Handle, Count };
+  enum Slots { Handle, CacheStoreId, Count };
   static const JSFunctionSpec static_methods[];
   static const JSPropertySpec static_properties[];
   static const JSFunctionSpec methods[];
   static const JSPropertySpec properties[];
 
   static bool get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool getMany(JSContext *cx, unsigned argc, JS::Value *vp);
 
   static host_api::Dict dictionary_handle(JSObject *obj);
   static bool constructor(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -5,6 +5,8 @@
 #include "js/experimental/TypedData.h" // used in "js/Conversions.h"
 #pragma clang diagnostic pop
 #include "../../StarlingMonkey/builtins/web/url.h"
+#include "../../StarlingMonkey/builtins/web/worker-location.h"
+#include "../common/geo_info.h"
 #include "./fetch/request-response.h"
 #include "backend.h"
 #include "encode.h"
@@ -17,6 +19,7 @@
 
 using builtins::web::url::URL;
 using builtins::web::url::URLSearchParams;
+using builtins::web::worker_location::WorkerLocation;
 using fastly::fastly::Fastly;
 using fastly::fetch::RequestOrResponse;
 using fastly::fetch::Response;
@@ -50,6 +53,7 @@ bool DEBUG_LOGGING_ENABLED = false;
 
 JS::PersistentRooted<JSObject *> Fastly::env;
 JS::PersistentRooted<JSObject *> Fastly::baseURL;
+bool Fastly::baseURLFromLocation = false;
 JS::PersistentRooted<JSString *> Fastly::defaultBackend;
 bool allowDynamicBackendsCalled = false;
 bool Fastly::allowDynamicBackends = true;
@@ -96,6 +100,63 @@ bool Fastly::enableDebugLogging(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
+bool Fastly::enableProfiling(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+  if (!args.requireAtLeast(cx, __func__, 1))
+    return false;
+  host_api::Profiler::set_enabled(JS::ToBoolean(args[0]));
+  args.rval().setUndefined();
+  return true;
+}
+
+// Returns the current request's profile as
+// `{ handlerTime, hostcalls: { [name]: { calls, time } } }`, with times in milliseconds, or null
+// if profiling isn't enabled.
+bool Fastly::profile(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+  if (!host_api::Profiler::enabled()) {
+    args.rval().setNull();
+    return true;
+  }
+
+  JS::RootedObject profile(cx, JS_NewPlainObject(cx));
+  if (!profile) {
+    return false;
+  }
+  JS::RootedValue handler_time(
+      cx, JS::NumberValue(static_cast<double>(host_api::Profiler::handler_nanoseconds()) / 1e6));
+  if (!JS_DefineProperty(cx, profile, "handlerTime", handler_time, JSPROP_ENUMERATE)) {
+    return false;
+  }
+
+  JS::RootedObject hostcalls(cx, JS_NewPlainObject(cx));
+  if (!hostcalls) {
+    return false;
+  }
+  for (const auto &stats : host_api::Profiler::hostcalls()) {
+    if (stats.calls == 0) {
+      continue;
+    }
+    JS::RootedObject entry(cx, JS_NewPlainObject(cx));
+    if (!entry) {
+      return false;
+    }
+    JS::RootedValue calls(cx, JS::NumberValue(static_cast<double>(stats.calls)));
+    JS::RootedValue time(cx, JS::NumberValue(static_cast<double>(stats.nanoseconds) / 1e6));
+    if (!JS_DefineProperty(cx, entry, "calls", calls, JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, entry, "time", time, JSPROP_ENUMERATE) ||
+        !JS_DefineProperty(cx, hostcalls, stats.name.c_str(), entry, JSPROP_ENUMERATE)) {
+      return false;
+    }
+  }
+  if (!JS_DefineProperty(cx, profile, "hostcalls", hostcalls, JSPROP_ENUMERATE)) {
+    return false;
+  }
+
+  args.rval().setObject(*profile);
+  return true;
+}
+
 bool debugLog(JSContext *cx, unsigned argc, JS::Value *vp) {
   JS::CallArgs args = CallArgsFromVp(argc, vp);
   if (!args.requireAtLeast(cx, __func__, 1))
@@ -149,25 +210,7 @@ bool Fastly::getGeolocationForIpAddress(JSContext *cx, unsigned argc, JS::Value
     return false;
   }
 
-  auto res = host_api::GeoIp::lookup(std::span<uint8_t>{octets, octets_len});
-  if (auto *err = res.to_err()) {
-    HANDLE_ERROR(cx, *err);
-    return false;
-  }
-
-  if (!res.unwrap().has_value()) {
-    args.rval().setNull();
-    return true;
-  }
-
-  auto ret = std::move(res.unwrap().value());
-
-  JS::RootedString geo_info_str(
-      cx, JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(ret.ptr.release(), ret.len)));
-  if (!geo_info_str)
-    return false;
-
-  return JS_ParseJSON(cx, geo_info_str, args.rval());
+  return common::get_geo_info(cx, std::span<uint8_t>{octets, octets_len}, true, args.rval());
 }
 
 bool Fastly::inspect(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -599,14 +642,35 @@ bool Fastly::version_get(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
+bool Fastly::base_url(JSContext *cx, JS::MutableHandleObject out) {
+  if (baseURLFromLocation) {
+    baseURLFromLocation = false;
+    JS::RootedObject url_instance(cx, JS_NewObjectWithGivenProto(cx, &URL::class_, URL::proto_obj));
+    if (!url_instance) {
+      return false;
+    }
+    baseURL = URL::create(cx, url_instance, URL::origin(cx, WorkerLocation::url));
+    if (!baseURL) {
+      return false;
+    }
+  }
+  out.set(baseURL);
+  return true;
+}
+
 bool Fastly::baseURL_get(JSContext *cx, unsigned argc, JS::Value *vp) {
   JS::CallArgs args = CallArgsFromVp(argc, vp);
-  args.rval().setObjectOrNull(baseURL);
+  JS::RootedObject base_url(cx);
+  if (!Fastly::base_url(cx, &base_url)) {
+    return false;
+  }
+  args.rval().setObjectOrNull(base_url);
   return true;
 }
 
 bool Fastly::baseURL_set(JSContext *cx, unsigned argc, JS::Value *vp) {
   JS::CallArgs args = CallArgsFromVp(argc, vp);
+  baseURLFromLocation = false;
   if (args.get(0).isNullOrUndefined()) {
     baseURL.set(nullptr);
   } else if (!URL::is_instance(args.get(0))) {
@@ -780,6 +844,7 @@ const JSPropertySpec Fastly::properties[] = {
 
 bool Fastly::restore_builtin_state(JSContext *cx) {
   Fastly::baseURL.reset();
+  Fastly::baseURLFromLocation = false;
   Fastly::defaultBackend.reset();
   Fastly::baseURL.init(cx);
   Fastly::defaultBackend.init(cx);
@@ -818,6 +883,7 @@ bool install(api::Engine *engine) {
       JS_FN("dump", Fastly::dump, 1, 0),
       JS_FN("enableDebugLogging", Fastly::enableDebugLogging, 1, JSPROP_ENUMERATE),
       JS_FN("debugLog", debugLog, 1, JSPROP_ENUMERATE),
+      JS_FN("profile", Fastly::profile, 0, JSPROP_ENUMERATE),
       JS_FN("getGeolocationForIpAddress", Fastly::getGeolocationForIpAddress, 1, JSPROP_ENUMERATE),
       JS_FN("inspect", Fastly::inspect, 1, JSPROP_ENUMERATE),
       JS_FN("getLogger", Fastly::getLogger, 1, JSPROP_ENUMERATE),
@@ -915,6 +981,20 @@ bool install(api::Engine *engine) {
   if (!JS_SetProperty(engine->cx(), experimental, "enableDebugLogging", enable_debug_logging_val)) {
     return false;
   }
+  auto enable_profiling =
+      JS_NewFunction(engine->cx(), &Fastly::enableProfiling, 1, 0, "enableProfiling");
+  RootedObject enable_profiling_obj(engine->cx(), JS_GetFunctionObject(enable_profiling));
+  RootedValue enable_profiling_val(engine->cx(), ObjectValue(*enable_profiling_obj));
+  if (!JS_SetProperty(engine->cx(), experimental, "enableProfiling", enable_profiling_val)) {
+    return false;
+  }
+  RootedValue profile_val(engine->cx());
+  if (!JS_GetProperty(engine->cx(), fastly, "profile", &profile_val)) {
+    return false;
+  }
+  if (!JS_SetProperty(engine->cx(), experimental, "profile", profile_val)) {
+    return false;
+  }
   auto allow_dynamic_backends =
       JS_NewFunction(engine->cx(), &Fastly::allowDynamicBackends_set, 1, 0, "allowDynamicBackends");
   RootedObject allow_dynamic_backends_obj(engine->cx(),
@@ -89,6 +89,9 @@ public:
 
   static JS::PersistentRooted<JSObject *> env;
   static JS::PersistentRooted<JSObject *> baseURL;
+  // Whether `baseURL` is still to be derived from the client request's URL. That takes a second URL
+  // parse, so it's put off until something actually uses the base URL.
+  static bool baseURLFromLocation;
   static JS::PersistentRooted<JSString *> defaultBackend;
   static bool allowDynamicBackends;
   static host_api::BackendConfig defaultDynamicBackendConfig;
@@ -101,6 +104,8 @@ public:
   static bool now(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool dump(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool enableDebugLogging(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool enableProfiling(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool profile(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool getGeolocationForIpAddress(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool getLogger(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool includeBytes(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -115,6 +120,12 @@ public:
   static bool inspect(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool setReusableSandboxOptions(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool restore_builtin_state(JSContext *cx);
+
+  /**
+   * Returns `fastly.baseURL` in `out`, first deriving it from the client request's URL if that
+   * hasn't happened yet.
+   */
+  static bool base_url(JSContext *cx, JS::MutableHandleObject out);
 };
 
 JS::Result<std::tuple<JS::UniqueChars, size_t>> convertBodyInit(JSContext *cx,
@@ -2,6 +2,7 @@
 #include "../../StarlingMonkey/builtins/web/performance.h"
 #include "../../StarlingMonkey/builtins/web/url.h"
 #include "../../StarlingMonkey/builtins/web/worker-location.h"
+#include "../common/geo_info.h"
 #include "../common/ip_octets_to_js_string.h"
 #include "../common/normalize_http_method.h"
 #include "../host-api/fastly.h"
@@ -11,8 +12,10 @@
 #include "fastly.h"
 #include "host_api.h"
 #include "js/JSON.h"
+#include "js/experimental/TypedData.h"
 #include "openssl/evp.h"
 
+#include <cstring>
 #include <iostream>
 #include <memory>
 
@@ -41,9 +44,10 @@ JSString *client_address(JSObject *obj) {
   return val.isString() ? val.toString() : nullptr;
 }
 
-JSString *geo_info(JSObject *obj) {
-  JS::Value val = JS::GetReservedSlot(obj, static_cast<uint32_t>(ClientInfo::Slots::GeoInfo));
-  return val.isString() ? val.toString() : nullptr;
+JSObject *client_address_octets(JSObject *obj) {
+  JS::Value val =
+      JS::GetReservedSlot(obj, static_cast<uint32_t>(ClientInfo::Slots::AddressOctets));
+  return val.isObject() ? val.toObjectOrNull() : nullptr;
 }
 
 JSString *cipher(JSObject *obj) {
@@ -91,13 +95,30 @@ JSString *ClientInfo::retrieve_client_address(JSContext *cx, JS::HandleObject se
     return nullptr;
   }
 
-  JS::RootedString address(cx, common::ip_octets_to_js_string(cx, std::move(res.unwrap())));
+  auto octets = std::move(res.unwrap());
+
+  // Keep the raw octets as well, so that `geo` and `addressOctets` don't have to parse the
+  // formatted address again. The array is never exposed to user code.
+  JS::RootedObject octets_array(cx, JS_NewUint8Array(cx, octets.len));
+  if (!octets_array) {
+    return nullptr;
+  }
+  {
+    JS::AutoCheckCannotGC noGC(cx);
+    bool is_shared;
+    void *buffer = JS_GetArrayBufferViewData(octets_array, &is_shared, noGC);
+    std::memcpy(buffer, octets.begin(), octets.len);
+  }
+
+  JS::RootedString address(cx, common::ip_octets_to_js_string(cx, std::move(octets)));
   if (!address) {
     return nullptr;
   }
 
   JS::SetReservedSlot(self, static_cast<uint32_t>(ClientInfo::Slots::Address),
                       JS::StringValue(address));
+  JS::SetReservedSlot(self, static_cast<uint32_t>(ClientInfo::Slots::AddressOctets),
+                      JS::ObjectValue(*octets_array));
   return address;
 }
 
@@ -142,61 +163,61 @@ bool ClientInfo::address_get(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
-bool ClientInfo::geo_get(JSContext *cx, unsigned argc, JS::Value *vp) {
-  METHOD_HEADER(0)
+bool ClientInfo::address_octets_get(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0);
 
-  JS::RootedString geo_info_str(cx, geo_info(self));
-  if (!geo_info_str) {
-    JS::RootedString address_str(cx, client_address(self));
-    if (!address_str) {
-      address_str = retrieve_client_address(cx, self);
-      if (!address_str) {
-        args.rval().setNull();
-        return true;
-      }
+  JS::RootedObject octets(cx, client_address_octets(self));
+  if (!octets) {
+    if (!retrieve_client_address(cx, self)) {
+      args.rval().setNull();
+      return true;
     }
+    octets = client_address_octets(self);
+  }
 
-    // TODO: skip intermediate encoding, and rely on the fact that we already had the bytes before
-    auto address = core::encode(cx, address_str);
-    if (!address) {
-      return false;
-    }
+  // The slot's array is what `geo` reads, so each access gets its own copy that user code is free
+  // to modify.
+  size_t len = JS_GetArrayBufferViewByteLength(octets);
+  JS::RootedObject copy(cx, JS_NewUint8Array(cx, len));
+  if (!copy) {
+    return false;
+  }
+  {
+    JS::AutoCheckCannotGC noGC(cx);
+    bool is_shared;
+    std::memcpy(JS_GetArrayBufferViewData(copy, &is_shared, noGC),
+                JS_GetArrayBufferViewData(octets, &is_shared, noGC), len);
+  }
 
-    // TODO: Remove all of this and rely on the host for validation as the hostcall only takes one
-    // user-supplied parameter
-    int format = AF_INET;
-    size_t octets_len = 4;
-    if (std::find(address.begin(), address.end(), ':') != address.end()) {
-      format = AF_INET6;
-      octets_len = 16;
-    }
+  args.rval().setObject(*copy);
+  return true;
+}
 
-    uint8_t octets[sizeof(struct in6_addr)];
-    if (inet_pton(format, address.begin(), octets) != 1) {
-      // While get_geo_info can be invoked through FetchEvent#client.geo, too,
-      // that path can't result in an invalid address here, so we can be more
-      // specific in the error message.
-      // TODO: Make a TypeError
-      JS_ReportErrorLatin1(cx, "Invalid address passed to fastly.getGeolocationForIpAddress");
-      return false;
-    }
+bool ClientInfo::geo_get(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0)
 
-    auto res = host_api::GeoIp::lookup(std::span<uint8_t>{octets, octets_len});
-    if (res.is_err() || !res.unwrap().has_value()) {
+  JS::RootedObject octets_array(cx, client_address_octets(self));
+  if (!octets_array) {
+    if (!retrieve_client_address(cx, self)) {
       args.rval().setNull();
       return true;
     }
+    octets_array = client_address_octets(self);
+  }
 
-    auto ret = std::move(res.unwrap().value());
-    geo_info_str =
-        JS::RootedString(cx, JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(ret.ptr.release(), ret.len)));
-    if (!geo_info_str)
-      return false;
-    JS::SetReservedSlot(self, static_cast<uint32_t>(ClientInfo::Slots::GeoInfo),
-                        JS::StringValue(geo_info_str));
+  uint8_t octets[sizeof(struct in6_addr)];
+  size_t octets_len = JS_GetArrayBufferViewByteLength(octets_array);
+  if (octets_len != 4 && octets_len != 16) {
+    args.rval().setNull();
+    return true;
+  }
+  {
+    JS::AutoCheckCannotGC noGC(cx);
+    bool is_shared;
+    std::memcpy(octets, JS_GetArrayBufferViewData(octets_array, &is_shared, noGC), octets_len);
   }
 
-  return JS_ParseJSON(cx, geo_info_str, args.rval());
+  return common::get_geo_info(cx, std::span<uint8_t>{octets, octets_len}, false, args.rval());
 }
 
 bool ClientInfo::tls_cipher_openssl_name_get(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -465,6 +486,7 @@ const JSFunctionSpec ClientInfo::methods[] = {
 const JSPropertySpec ClientInfo::properties[] = {
     JS_PSG("requestId", request_id_get, JSPROP_ENUMERATE),
     JS_PSG("address", address_get, JSPROP_ENUMERATE),
+    JS_PSG("addressOctets", address_octets_get, JSPROP_ENUMERATE),
     JS_PSG("geo", geo_get, JSPROP_ENUMERATE),
     JS_PSG("tlsCipherOpensslName", tls_cipher_openssl_name_get, JSPROP_ENUMERATE),
     JS_PSG("tlsProtocol", tls_protocol_get, JSPROP_ENUMERATE),
@@ -763,15 +785,9 @@ bool FetchEvent::init_request(JSContext *cx, JS::HandleObject self, host_api::Ht
 
   // Set `fastly.baseURL` to the origin of the client request's URL.
   // Note that this only happens if baseURL hasn't already been set to another
-  // value explicitly.
+  // value explicitly, and that the URL is only created once it's first used.
   if (!Fastly::baseURL.get()) {
-    JS::RootedObject url_instance(cx, JS_NewObjectWithGivenProto(cx, &URL::class_, URL::proto_obj));
-    if (!url_instance)
-      return false;
-
-    Fastly::baseURL = URL::create(cx, url_instance, URL::origin(cx, WorkerLocation::url));
-    if (!Fastly::baseURL)
-      return false;
+    Fastly::baseURLFromLocation = true;
   }
 
   return true;
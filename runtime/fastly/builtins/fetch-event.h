@@ -12,6 +12,7 @@ namespace fastly::fetch_event {
 class ClientInfo final : public builtins::BuiltinNoConstructor<ClientInfo> {
   static bool request_id_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool address_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool address_octets_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool geo_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool tls_cipher_openssl_name_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool tls_protocol_get(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -31,7 +32,6 @@ public:
   enum class Slots {
     Request,
     Address,
-    GeoInfo,
     Cipher,
     Protocol,
     ClientHello,
@@ -42,6 +42,7 @@ public:
     ClientCert,
     ClientRequestId,
     ClientSNI,
+    AddressOctets,
     Count,
   };
   static const JSFunctionSpec static_methods[];
@@ -203,6 +203,50 @@ bool get_caching_mode(JSContext *cx, HandleObject request, CachingMode *caching_
   return true;
 }
 
+// Sends the request to the image optimizer, settling `response_promise` with the response.
+bool send_image_optimizer(JSContext *cx, HandleObject request, std::string_view backend,
+                          HandleObject response_promise) {
+  auto config = reinterpret_cast<fastly::image_optimizer::ImageOptimizerOptions *>(
+      JS::GetReservedSlot(request, static_cast<uint32_t>(Request::Slots::ImageOptimizerOptions))
+          .toPrivate());
+  auto config_str = config->to_string();
+  auto res = Request::request_handle(request).send_image_optimizer(
+      RequestOrResponse::body_handle(request), backend, config_str);
+  if (auto *err = res.to_err()) {
+    HANDLE_IMAGE_OPTIMIZER_ERROR(cx, *err);
+    return RejectPromiseWithPendingError(cx, response_promise);
+  }
+
+  JS::RootedObject response(cx, Response::create(cx, request, res.unwrap()));
+  if (!response) {
+    return false;
+  }
+  JS::RootedValue response_val(cx, JS::ObjectValue(*response));
+  return JS::ResolvePromise(cx, response_promise, response_val);
+}
+
+bool image_optimizer_body_tee_then(JSContext *cx, JS::HandleObject request,
+                                   JS::HandleValue response_promise, JS::CallArgs args) {
+  JS::RootedObject response_promise_obj(cx, &response_promise.toObject());
+  args.rval().setUndefined();
+  RootedString backend(cx, get_backend(cx, request));
+  if (!backend) {
+    return RejectPromiseWithPendingError(cx, response_promise_obj);
+  }
+  host_api::HostString backend_chars = core::encode(cx, backend);
+  if (!backend_chars.ptr) {
+    return RejectPromiseWithPendingError(cx, response_promise_obj);
+  }
+  return send_image_optimizer(cx, request, backend_chars, response_promise_obj);
+}
+
+bool image_optimizer_body_tee_catch(JSContext *cx, JS::HandleObject request,
+                                    JS::HandleValue response_promise, JS::CallArgs args) {
+  JS::RootedObject response_promise_obj(cx, &response_promise.toObject());
+  args.rval().setUndefined();
+  return JS::RejectPromise(cx, response_promise_obj, args.get(0));
+}
+
 // Sends the request body, resolving the response promise with the response
 template <CachingMode caching_mode>
 bool fetch_send_body(JSContext *cx, HandleObject request, JS::MutableHandleValue ret) {
@@ -251,6 +295,22 @@ bool fetch_send_body(JSContext *cx, HandleObject request, JS::MutableHandleValue
     return false;
   }
 
+  // The image optimizer does not support streaming, so it's only sent a body that `Request#clone`
+  // is still copying into once the copy is done.
+  if (caching_mode == CachingMode::ImageOptimizer && RequestOrResponse::body_tee_pending(request)) {
+    JS::RootedObject body_tee_done(cx, RequestOrResponse::body_tee_done(cx, request));
+    if (!body_tee_done) {
+      return false;
+    }
+    JS::RootedValue response_promise_val(cx, JS::ObjectValue(*response_promise));
+    if (!internal_method_then<image_optimizer_body_tee_then, image_optimizer_body_tee_catch>(
+            cx, body_tee_done, request, response_promise_val)) {
+      return false;
+    }
+    ret.setObject(*response_promise);
+    return true;
+  }
+
   // The image optimizer does not support streaming, so never stream in this case
   bool streaming = false;
   if (caching_mode != CachingMode::ImageOptimizer &&
@@ -276,20 +336,7 @@ bool fetch_send_body(JSContext *cx, HandleObject request, JS::MutableHandleValue
       res = request_handle.send_async_without_caching(body, backend_chars, streaming);
       break;
     case CachingMode::ImageOptimizer: {
-      auto config = reinterpret_cast<fastly::image_optimizer::ImageOptimizerOptions *>(
-          JS::GetReservedSlot(request, static_cast<uint32_t>(Request::Slots::ImageOptimizerOptions))
-              .toPrivate());
-      auto config_str = config->to_string();
-      auto res = request_handle.send_image_optimizer(body, backend_chars, config_str);
-      if (auto *err = res.to_err()) {
-        HANDLE_IMAGE_OPTIMIZER_ERROR(cx, *err);
-        ret.setObject(*PromiseRejectedWithPendingError(cx));
-        return true;
-      }
-
-      JS::RootedObject response(cx, Response::create(cx, request, res.unwrap()));
-      JS::RootedValue response_val(cx, JS::ObjectValue(*response));
-      if (!JS::ResolvePromise(cx, response_promise, response_val)) {
+      if (!send_image_optimizer(cx, request, backend_chars, response_promise)) {
         return false;
       }
       ret.setObject(*response_promise);
@@ -431,6 +478,8 @@ bool fetch_send_body_with_cache_hooks(JSContext *cx, HandleObject request,
   // cache origin request.
   JS::SetReservedSlot(request, static_cast<uint32_t>(Request::Slots::Request),
                       JS::Int32Value(backend_request_handle.handle));
+  // The record of committed headers describes the original handle, not the new one.
+  RequestOrResponse::reset_committed_headers(request);
   JS::SetReservedSlot(request, static_cast<uint32_t>(RequestOrResponse::Slots::CacheEntry),
                       JS::Int32Value(cache_entry.handle));
 
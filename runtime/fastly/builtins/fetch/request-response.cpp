@@ -15,12 +15,14 @@
 #include "../../../StarlingMonkey/runtime/encode.h"
 #include "../../common/ip_octets_to_js_string.h"
 #include "../../common/normalize_http_method.h"
+#include "../../common/utf16_to_utf8.h"
 #include "../backend.h"
 #include "../cache-core.h"
 #include "../cache-override.h"
 #include "../cache-simple.h"
 #include "../fastly.h"
 #include "../fetch-event.h"
+#include "../html-rewriter.h"
 #include "../image-optimizer.h"
 #include "../kv-store.h"
 #include "extension-api.h"
@@ -34,6 +36,7 @@
 #include "js/Stream.h"
 #include "picosha2.h"
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
 #pragma clang diagnostic push
@@ -86,8 +89,13 @@ namespace builtins::web::streams {
 
 bool NativeStreamSource::stream_is_body(JSContext *cx, JS::HandleObject stream) {
   JSObject *stream_source = get_stream_source(cx, stream);
-  return NativeStreamSource::is_instance(stream_source) &&
-         fastly::fetch::RequestOrResponse::is_instance(owner(stream_source));
+  if (!NativeStreamSource::is_instance(stream_source)) {
+    return false;
+  }
+  JSObject *owner = NativeStreamSource::owner(stream_source);
+  // A body that `Request#clone` is still copying into can only be read through the stream.
+  return fastly::fetch::RequestOrResponse::is_instance(owner) &&
+         !fastly::fetch::RequestOrResponse::body_tee_pending(owner);
 }
 
 } // namespace builtins::web::streams
@@ -106,7 +114,46 @@ bool error_stream_controller_with_pending_exception(JSContext *cx, JS::HandleObj
   return JS::ReadableStreamError(cx, stream, args);
 }
 
-constexpr size_t HANDLE_READ_CHUNK_SIZE = 8192;
+constexpr size_t HANDLE_READ_CHUNK_SIZE = host_api::BodyReadSizer::MIN_CHUNK_SIZE;
+
+// Body streams are read one chunk per async task, so the read sizing state is kept on the body's
+// owner in between reads, allowing the chunk size to keep growing over the life of the stream.
+// Reads are further capped at `max_chunk_size`, for readers whose buffers are limited in size.
+host_api::BodyReadSizer body_read_sizer(JSObject *owner, host_api::HttpBody body,
+                                        size_t max_chunk_size = SIZE_MAX) {
+  max_chunk_size = std::min(max_chunk_size, RequestOrResponse::max_body_chunk_size(owner));
+  JS::Value chunk_size = JS::GetReservedSlot(
+      owner, static_cast<uint32_t>(RequestOrResponse::Slots::BodyReadChunkSize));
+  if (chunk_size.isInt32()) {
+    return host_api::BodyReadSizer(static_cast<size_t>(chunk_size.toInt32()), max_chunk_size);
+  }
+  return host_api::BodyReadSizer::for_body(body, max_chunk_size);
+}
+
+void set_body_read_sizer(JSObject *owner, const host_api::BodyReadSizer &sizer) {
+  static_assert(host_api::BodyReadSizer::MAX_CHUNK_SIZE <= INT32_MAX);
+  JS::SetReservedSlot(owner, static_cast<uint32_t>(RequestOrResponse::Slots::BodyReadChunkSize),
+                      JS::Int32Value(static_cast<int32_t>(sizer.chunk_size())));
+}
+
+// Returns the HTMLRewritingStream that `transform` is the internal TransformStream of, if any.
+JSObject *owning_html_rewriter(JSObject *transform) {
+  if (!transform || !TransformStream::used_as_mixin(transform)) {
+    return nullptr;
+  }
+  JSObject *owner = TransformStream::owner(transform);
+  if (!owner || !html_rewriter::HTMLRewritingStream::is_instance(owner)) {
+    return nullptr;
+  }
+  return owner;
+}
+
+// Whether a host-backed body stream has had any chunk read from it yet.
+bool body_read_started(JSObject *owner) {
+  return !JS::GetReservedSlot(owner,
+                              static_cast<uint32_t>(RequestOrResponse::Slots::BodyReadChunkSize))
+              .isUndefined();
+}
 
 void set_up_shortcutting(JSContext *cx, JS::HandleObject stream, JS::HandleObject to) {
   // This function is part of a web of code that allows requests and responses
@@ -148,6 +195,12 @@ bool maybe_shortcut_transform_stream_read(JSContext *cx, JS::HandleObject stream
   // piped in at the same time. There may be a chain of TransformStreams in
   // between the source and destination, so we walk the piping chain to find the
   // final destination.
+  //
+  // A body that `Request#clone` is still copying into isn't complete yet, so it
+  // can't be appended.
+  if (RequestOrResponse::body_tee_pending(body_owner)) {
+    return true;
+  }
   JS::RootedObject pipe_dest(cx, NativeStreamSource::piped_to_transform_stream(streamSource));
   if (pipe_dest) {
     *shortcutted = true;
@@ -229,6 +282,78 @@ bool maybe_shortcut_transform_stream_read(JSContext *cx, JS::HandleObject stream
   return true;
 }
 
+bool process_body_read(JSContext *cx, host_api::HttpBody::Handle handle, JS::HandleObject context,
+                       JS::HandleValue body_owner);
+
+// A read of a body that `Request#clone` is still copying into can run out of data before the copy
+// is done. The read is then retried by `process_body_tee` once more data has been copied.
+bool wait_for_body_tee(JSObject *owner, JSObject *stream_source) {
+  JS::SetReservedSlot(owner, static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeeReader),
+                      JS::ObjectValue(*stream_source));
+  return true;
+}
+
+bool resume_body_read_into_html_rewriter(JSContext *cx, JS::HandleObject stream_source,
+                                         JS::HandleValue body_owner, JS::CallArgs args) {
+  JS::RootedObject owner(cx, NativeStreamSource::owner(stream_source));
+  ENGINE->queue_async_task(new FastlyAsyncTask(RequestOrResponse::body_handle(owner).async_handle(),
+                                               stream_source, body_owner, process_body_read));
+  args.rval().setUndefined();
+  return true;
+}
+
+bool process_body_read_into_html_rewriter(JSContext *cx, host_api::HttpBody body,
+                                          JS::HandleObject stream_source,
+                                          JS::HandleObject rewriter, JS::HandleValue body_owner) {
+  JS::RootedObject owner(cx, NativeStreamSource::owner(stream_source));
+  JS::RootedObject stream(cx, NativeStreamSource::stream(stream_source));
+
+  // Each chunk is read into the hostcall arena, and reads are kept small enough for the arena to
+  // reuse its memory for them rather than making a separate allocation for every chunk.
+  auto sizer = body_read_sizer(owner, body, host_api::HostcallArena::max_retained_size());
+  host_api::HostcallArena::Scope scratch;
+  uint8_t *buf = scratch.alloc(sizer.chunk_size());
+  auto read_res = body.read_into(buf, sizer.chunk_size());
+  if (auto *err = read_res.to_err()) {
+    HANDLE_ERROR(cx, *err);
+    return error_stream_controller_with_pending_exception(cx, stream);
+  }
+
+  auto len = read_res.unwrap();
+  if (len == 0) {
+    if (RequestOrResponse::body_tee_pending(owner)) {
+      return wait_for_body_tee(owner, stream_source);
+    }
+    // Closing the source ends the pipe, which closes the rewriter's writable side and thereby
+    // flushes the rewriter.
+    return JS::ReadableStreamClose(cx, stream);
+  }
+  sizer.record(len);
+  set_body_read_sizer(owner, sizer);
+
+  if (!html_rewriter::HTMLRewritingStream::write_input(cx, rewriter, buf, len)) {
+    return error_stream_controller_with_pending_exception(cx, stream);
+  }
+
+  // Nothing was enqueued, so the stream won't pull again: schedule the next read ourselves. If the
+  // rewriter's readable side is full, that waits until it's read from, so that the rest of the
+  // body isn't queued up there.
+  JS::RootedObject backpressure(
+      cx, html_rewriter::HTMLRewritingStream::output_backpressure(rewriter));
+  if (backpressure) {
+    JS::RootedObject resume(
+        cx, create_internal_method<resume_body_read_into_html_rewriter>(cx, stream_source,
+                                                                        body_owner));
+    if (!resume) {
+      return false;
+    }
+    return JS::AddPromiseReactions(cx, backpressure, resume, resume);
+  }
+  ENGINE->queue_async_task(
+      new FastlyAsyncTask(body.async_handle(), stream_source, body_owner, process_body_read));
+  return true;
+}
+
 bool process_body_read(JSContext *cx, host_api::HttpBody::Handle handle, JS::HandleObject context,
                        JS::HandleValue body_owner) {
   MOZ_ASSERT(context);
@@ -247,7 +372,24 @@ bool process_body_read(JSContext *cx, host_api::HttpBody::Handle handle, JS::Han
     return true;
   }
 
-  auto read_res = body.read(HANDLE_READ_CHUNK_SIZE);
+  // A host body piped straight into an HTMLRewritingStream is fed to the rewriter natively, one
+  // chunk per task, without going through JS chunks or the rewriter's writable side. This is only
+  // done from the first read on, so that no chunk can still be queued up for the writable side.
+  JS::RootedObject rewriter(
+      cx, owning_html_rewriter(NativeStreamSource::piped_to_transform_stream(streamSource)));
+  if (rewriter) {
+    using html_rewriter::HTMLRewritingStream;
+    bool native = HTMLRewritingStream::native_input(rewriter);
+    if (!native && !body_read_started(owner)) {
+      native = HTMLRewritingStream::start_native_input(rewriter);
+    }
+    if (native) {
+      return process_body_read_into_html_rewriter(cx, body, streamSource, rewriter, body_owner);
+    }
+  }
+
+  auto sizer = body_read_sizer(owner, body);
+  auto read_res = body.read(sizer.chunk_size());
   if (auto *err = read_res.to_err()) {
     HANDLE_ERROR(cx, *err);
     return error_stream_controller_with_pending_exception(cx, stream);
@@ -255,9 +397,14 @@ bool process_body_read(JSContext *cx, host_api::HttpBody::Handle handle, JS::Han
 
   auto &chunk = read_res.unwrap();
   if (chunk.len == 0) {
+    if (RequestOrResponse::body_tee_pending(owner)) {
+      return wait_for_body_tee(owner, streamSource);
+    }
     JS::RootedValue r(cx);
     return JS::ReadableStreamClose(cx, stream);
   }
+  sizer.record(chunk.len);
+  set_body_read_sizer(owner, sizer);
 
   // We don't release control of chunk's data until after we've checked that the array buffer
   // allocation has been successful, as that ensures that the return path frees chunk automatically
@@ -286,6 +433,201 @@ bool process_body_read(JSContext *cx, host_api::HttpBody::Handle handle, JS::Han
   return true;
 }
 
+// Retries a read of `owner`'s body stream that ran out of data while `Request#clone` was copying
+// into the body.
+bool wake_body_tee_reader(JSContext *cx, JS::HandleObject owner) {
+  auto reader_slot = static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeeReader);
+  JS::RootedValue reader(cx, JS::GetReservedSlot(owner, reader_slot));
+  if (reader.isUndefined()) {
+    return true;
+  }
+  JS::SetReservedSlot(owner, reader_slot, JS::UndefinedValue());
+  JS::RootedObject stream_source(cx, &reader.toObject());
+  JS::RootedValue owner_val(cx, JS::ObjectValue(*owner));
+  return process_body_read(cx, RequestOrResponse::body_handle(owner).handle, stream_source,
+                           owner_val);
+}
+
+// Ends the copy into `owner`'s body. If the request was sent while the copy was running, the
+// streaming send is finished as `body_reader_then_handler` does for streams. A body that couldn't
+// be copied in full is closed, so that reading it fails instead of ending early.
+bool finish_body_tee(JSContext *cx, JS::HandleObject owner, bool failed) {
+  if (!RequestOrResponse::body_tee_pending(owner)) {
+    return true;
+  }
+  JS::SetReservedSlot(owner, static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeeSource),
+                      JS::UndefinedValue());
+
+  auto done_slot = static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeeDone);
+  JS::RootedValue done(cx, JS::GetReservedSlot(owner, done_slot));
+  if (done.isObject()) {
+    JS::SetReservedSlot(owner, done_slot, JS::UndefinedValue());
+    JS::RootedObject done_promise(cx, &done.toObject());
+    if (failed) {
+      JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr, JSMSG_BODY_TEE_FAILED);
+      if (!RejectPromiseWithPendingError(cx, done_promise)) {
+        return false;
+      }
+    } else if (!JS::ResolvePromise(cx, done_promise, JS::UndefinedHandleValue)) {
+      return false;
+    }
+  }
+
+  auto body = RequestOrResponse::body_handle(owner);
+  if (Request::is_instance(owner) &&
+      JS::GetReservedSlot(owner, static_cast<uint32_t>(Request::Slots::PendingRequest))
+          .isInt32()) {
+    if (failed) {
+      std::ignore = body.abandon();
+    } else {
+      auto res = body.close();
+      if (auto *err = res.to_err()) {
+        HANDLE_ERROR(cx, *err);
+        return false;
+      }
+    }
+    JS::RootedValue promise(cx, JS::ObjectValue(*Request::response_promise(owner)));
+    ENGINE->queue_async_task(new FastlyAsyncTask(Request::pending_handle(owner).async_handle(),
+                                                 owner, promise,
+                                                 RequestOrResponse::process_pending_request));
+    return true;
+  }
+
+  if (failed) {
+    std::ignore = body.close();
+  }
+  return wake_body_tee_reader(cx, owner);
+}
+
+// Writes a chunk copied by `Request#clone` into `owner`'s body, unless copying into it has ended.
+bool write_body_tee_chunk(JSContext *cx, JS::HandleObject owner, const uint8_t *buf, size_t len) {
+  if (!RequestOrResponse::body_tee_pending(owner)) {
+    return true;
+  }
+  if (RequestOrResponse::body_handle(owner).write_all_back(buf, len).is_err()) {
+    return finish_body_tee(cx, owner, true);
+  }
+  return wake_body_tee_reader(cx, owner);
+}
+
+// Returns the object that has taken over `owner`'s part in the copy `Request#clone` makes.
+JSObject *body_tee_owner(JSObject *owner) {
+  JS::Value moved_to;
+  while ((moved_to = JS::GetReservedSlot(
+              owner, static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeeMovedTo)))
+             .isObject()) {
+    owner = &moved_to.toObject();
+  }
+  return owner;
+}
+
+// Copies the body `Request#clone` was called on into the bodies of the original request and the
+// clone, as the source body has data available. Each task copies what's ready, up to a maximum
+// read's worth, and then queues the next one on the source's async handle, so other tasks run in
+// between and neither request waits for the whole body before it can be sent or read.
+bool process_body_tee(JSContext *cx, host_api::HttpBody::Handle handle, JS::HandleObject context,
+                      JS::HandleValue extra) {
+  host_api::HttpBody source(handle);
+  // Either request may have been used to create a new Request since the copy was last queued,
+  // which then took over its part in the copy, see `RequestOrResponse::move_body_tee`.
+  JS::RootedObject original(cx, body_tee_owner(context));
+  JS::RootedObject clone(cx, body_tee_owner(&extra.toObject()));
+
+  // Chunks are read into the hostcall arena, so reads are capped at what the arena keeps between
+  // requests, letting every read reuse its memory.
+  auto sizer =
+      host_api::BodyReadSizer::for_body(source, host_api::HostcallArena::max_retained_size());
+  size_t copied = 0;
+  while (copied < host_api::BodyReadSizer::MAX_CHUNK_SIZE) {
+    host_api::HostcallArena::Scope scratch;
+    uint8_t *buf = scratch.alloc(sizer.chunk_size());
+    auto read_res = source.read_into(buf, sizer.chunk_size());
+    if (read_res.is_err() || read_res.unwrap() == 0) {
+      bool failed = read_res.is_err();
+      std::ignore = source.close();
+      return finish_body_tee(cx, original, failed) && finish_body_tee(cx, clone, failed);
+    }
+
+    auto len = read_res.unwrap();
+    sizer.record(len);
+    copied += len;
+    if (!write_body_tee_chunk(cx, original, buf, len) ||
+        !write_body_tee_chunk(cx, clone, buf, len)) {
+      return false;
+    }
+    if (!RequestOrResponse::body_tee_pending(original) &&
+        !RequestOrResponse::body_tee_pending(clone)) {
+      std::ignore = source.close();
+      return true;
+    }
+
+    auto ready_res = source.is_ready();
+    if (ready_res.is_err() || !ready_res.unwrap()) {
+      break;
+    }
+  }
+
+  JS::RootedValue clone_val(cx, JS::ObjectValue(*clone));
+  ENGINE->queue_async_task(
+      new FastlyAsyncTask(source.async_handle(), original, clone_val, process_body_tee));
+  return true;
+}
+
+// Gives `original`, whose body nothing has read yet, and `clone` a new body each, which the body
+// of `original` is copied into once either of them is read or sent, see `start_body_tee`.
+bool prepare_body_tee(JSContext *cx, JS::HandleObject original, JS::HandleObject clone) {
+  auto source = RequestOrResponse::body_handle(original);
+
+  auto first_res = host_api::HttpBody::make();
+  if (auto *err = first_res.to_err()) {
+    HANDLE_ERROR(cx, *err);
+    return false;
+  }
+  auto first = first_res.unwrap();
+  auto second_res = host_api::HttpBody::make();
+  if (auto *err = second_res.to_err()) {
+    std::ignore = first.close();
+    HANDLE_ERROR(cx, *err);
+    return false;
+  }
+  auto second = second_res.unwrap();
+
+  JS::Value source_val = JS::Int32Value(source.handle);
+  JS::SetReservedSlot(original, static_cast<uint32_t>(RequestOrResponse::Slots::Body),
+                      JS::Int32Value(first.handle));
+  JS::SetReservedSlot(original, static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeeSource),
+                      source_val);
+  JS::SetReservedSlot(clone, static_cast<uint32_t>(RequestOrResponse::Slots::Body),
+                      JS::Int32Value(second.handle));
+  JS::SetReservedSlot(clone, static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeeSource),
+                      source_val);
+  JS::SetReservedSlot(original, static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeePeer),
+                      JS::ObjectValue(*clone));
+  JS::SetReservedSlot(clone, static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeePeer),
+                      JS::ObjectValue(*original));
+  return true;
+}
+
+// Starts the copy `prepare_body_tee` set up for `owner`, unless it's already running. The copy is
+// only started once one of the requests is read or sent, so that a clone that's dropped unused
+// doesn't cause the whole body to be read and copied twice.
+void start_body_tee(JSContext *cx, JS::HandleObject owner) {
+  auto peer_slot = static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeePeer);
+  JS::Value peer = JS::GetReservedSlot(owner, peer_slot);
+  if (!peer.isObject()) {
+    return;
+  }
+  JS::RootedValue peer_val(cx, peer);
+  JS::SetReservedSlot(owner, peer_slot, JS::UndefinedValue());
+  JS::SetReservedSlot(&peer_val.toObject(), peer_slot, JS::UndefinedValue());
+
+  host_api::HttpBody source(
+      JS::GetReservedSlot(owner, static_cast<uint32_t>(RequestOrResponse::Slots::BodyTeeSource))
+          .toInt32());
+  ENGINE->queue_async_task(
+      new FastlyAsyncTask(source.async_handle(), owner, peer_val, process_body_tee));
+}
+
 enum StreamState { Complete, Wait, Error };
 
 struct ReadResult {
@@ -294,9 +636,80 @@ struct ReadResult {
   StreamState state;
 };
 
+// Reads a body whose length the host reported up front straight into a single allocation of that
+// length, avoiding both the per-chunk allocations and the final copy into a combined buffer. The
+// buffer has one spare byte so that the end-of-stream read doesn't require a reallocation, and
+// grows if the body turns out to be longer than reported.
+template <bool async>
+ReadResult read_from_handle_with_known_length(JSContext *cx, host_api::HttpBody body,
+                                              uint64_t length) {
+  if (length >= SIZE_MAX) {
+    JS_ReportOutOfMemory(cx);
+    return {nullptr, 0, StreamState::Error};
+  }
+  size_t buf_cap = static_cast<size_t>(length) + 1;
+  JS::UniqueChars buf(static_cast<char *>(JS_string_malloc(cx, buf_cap)));
+  if (!buf) {
+    JS_ReportOutOfMemory(cx);
+    return {nullptr, 0, StreamState::Error};
+  }
+
+  size_t bytes_read = 0;
+  bool end_of_stream = true;
+  while (true) {
+    if (async) {
+      auto ready_res = body.is_ready();
+      if (auto *err = ready_res.to_err()) {
+        HANDLE_ERROR(cx, *err);
+        return {nullptr, 0, StreamState::Error};
+      }
+      if (!ready_res.unwrap()) {
+        end_of_stream = false;
+        break;
+      }
+    }
+    if (bytes_read == buf_cap) {
+      if (buf_cap > SIZE_MAX / 2) {
+        JS_ReportOutOfMemory(cx);
+        return {nullptr, 0, StreamState::Error};
+      }
+      auto *new_buf = static_cast<char *>(JS_string_realloc(cx, buf.get(), buf_cap, buf_cap * 2));
+      if (!new_buf) {
+        JS_ReportOutOfMemory(cx);
+        return {nullptr, 0, StreamState::Error};
+      }
+      std::ignore = buf.release();
+      buf.reset(new_buf);
+      buf_cap *= 2;
+    }
+    auto res =
+        body.read_into(reinterpret_cast<uint8_t *>(buf.get() + bytes_read), buf_cap - bytes_read);
+    if (auto *err = res.to_err()) {
+      HANDLE_ERROR(cx, *err);
+      return {nullptr, 0, StreamState::Error};
+    }
+    auto len = res.unwrap();
+    if (len == 0) {
+      break;
+    }
+    bytes_read += len;
+  }
+
+  auto state = end_of_stream ? StreamState::Complete : StreamState::Wait;
+  if (bytes_read == 0) {
+    return {nullptr, 0, state};
+  }
+  return {std::move(buf), bytes_read, state};
+}
+
 // Returns a UniqueChars and the length of that string. The UniqueChars value is not
 // null-terminated.
 template <bool async> ReadResult read_from_handle_all(JSContext *cx, host_api::HttpBody body) {
+  auto sizer = host_api::BodyReadSizer::for_body(body);
+  if (auto length = sizer.known_length()) {
+    return read_from_handle_with_known_length<async>(cx, body, length.value());
+  }
+
   std::vector<host_api::HostString> chunks;
   size_t bytes_read = 0;
   bool end_of_stream = true;
@@ -312,7 +725,7 @@ template <bool async> ReadResult read_from_handle_all(JSContext *cx, host_api::H
         break;
       }
     }
-    auto res = body.read(HANDLE_READ_CHUNK_SIZE);
+    auto res = body.read(sizer.chunk_size());
     if (auto *err = res.to_err()) {
       HANDLE_ERROR(cx, *err);
       return {nullptr, 0, StreamState::Error};
@@ -323,6 +736,7 @@ template <bool async> ReadResult read_from_handle_all(JSContext *cx, host_api::H
       break;
     }
 
+    sizer.record(chunk.len);
     bytes_read += chunk.len;
     chunks.emplace_back(std::move(chunk));
   }
@@ -853,6 +1267,51 @@ bool RequestOrResponse::body_used(JSObject *obj) {
   return JS::GetReservedSlot(obj, static_cast<uint32_t>(Slots::BodyUsed)).toBoolean();
 }
 
+bool RequestOrResponse::body_tee_pending(JSObject *obj) {
+  return JS::GetReservedSlot(obj, static_cast<uint32_t>(Slots::BodyTeeSource)).isInt32();
+}
+
+JSObject *RequestOrResponse::body_tee_done(JSContext *cx, JS::HandleObject obj) {
+  MOZ_ASSERT(body_tee_pending(obj));
+  auto done_slot = static_cast<uint32_t>(Slots::BodyTeeDone);
+  JS::Value done = JS::GetReservedSlot(obj, done_slot);
+  if (done.isObject()) {
+    return &done.toObject();
+  }
+  JS::RootedObject done_promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!done_promise) {
+    return nullptr;
+  }
+  JS::SetReservedSlot(obj, done_slot, JS::ObjectValue(*done_promise));
+  start_body_tee(cx, obj);
+  return done_promise;
+}
+
+size_t RequestOrResponse::max_body_chunk_size(JSObject *obj) {
+  JS::Value max = JS::GetReservedSlot(obj, static_cast<uint32_t>(Slots::BodyReadMaxChunkSize));
+  return max.isInt32() ? static_cast<size_t>(max.toInt32())
+                       : host_api::BodyReadSizer::MAX_CHUNK_SIZE;
+}
+
+bool RequestOrResponse::set_max_body_chunk_size(JSContext *cx, JS::HandleObject self,
+                                                JS::HandleValue size_val, const char *method) {
+  double size;
+  if (!JS::ToNumber(cx, size_val, &size)) {
+    return false;
+  }
+  if (!(size >= host_api::BodyReadSizer::MIN_CHUNK_SIZE &&
+        size <= host_api::BodyReadSizer::MAX_CHUNK_SIZE) ||
+      std::trunc(size) != size) {
+    JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr, JSMSG_BODY_CHUNK_SIZE_INVALID,
+                              method);
+    return false;
+  }
+  JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::BodyReadMaxChunkSize),
+                      JS::Int32Value(static_cast<int32_t>(size)));
+  // Reads that have already grown past the new maximum are clamped to it by `body_read_sizer`.
+  return true;
+}
+
 bool RequestOrResponse::mark_body_used(JSContext *cx, JS::HandleObject obj) {
   MOZ_ASSERT(!body_used(obj));
   JS::SetReservedSlot(obj, static_cast<uint32_t>(Slots::BodyUsed), JS::BooleanValue(true));
@@ -896,6 +1355,29 @@ bool RequestOrResponse::move_body_handle(JSContext *cx, JS::HandleObject from,
   return mark_body_used(cx, from);
 }
 
+bool RequestOrResponse::move_body_tee(JSContext *cx, JS::HandleObject from, JS::HandleObject to) {
+  MOZ_ASSERT(body_tee_pending(from));
+  MOZ_ASSERT(!body_stream(from));
+
+  for (auto slot : {Slots::BodyTeeSource, Slots::BodyTeePeer, Slots::BodyTeeDone}) {
+    JS::SetReservedSlot(to, static_cast<uint32_t>(slot),
+                        JS::GetReservedSlot(from, static_cast<uint32_t>(slot)));
+    JS::SetReservedSlot(from, static_cast<uint32_t>(slot), JS::UndefinedValue());
+  }
+
+  // If the copy hasn't started yet, it's started with `to` instead. Otherwise, the copy that's
+  // already running is pointed at `to`, see `process_body_tee`.
+  JS::Value peer = JS::GetReservedSlot(to, static_cast<uint32_t>(Slots::BodyTeePeer));
+  if (peer.isObject()) {
+    JS::SetReservedSlot(&peer.toObject(), static_cast<uint32_t>(Slots::BodyTeePeer),
+                        JS::ObjectValue(*to));
+  } else {
+    JS::SetReservedSlot(from, static_cast<uint32_t>(Slots::BodyTeeMovedTo), JS::ObjectValue(*to));
+  }
+
+  return move_body_handle(cx, from, to);
+}
+
 JS::Value RequestOrResponse::url(JSObject *obj) {
   MOZ_ASSERT(is_instance(obj));
   JS::Value val = JS::GetReservedSlot(obj, static_cast<uint32_t>(RequestOrResponse::Slots::URL));
@@ -1194,7 +1676,20 @@ bool RequestOrResponse::commit_headers(JSContext *cx, HandleObject self) {
     headers_handle = Response::response_handle(self).headers_writable();
   }
 
-  auto res = host_api::write_headers(headers_handle, *list);
+  // Headers are usually committed more than once only after small changes, such as adding a header
+  // to a proxied request, so keep track of what the handle has and only write the differences.
+  JS::Value committed_val =
+      JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::CommittedHeaders));
+  host_api::CommittedHeaders *committed;
+  if (committed_val.isUndefined()) {
+    committed = new host_api::CommittedHeaders();
+    JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::CommittedHeaders),
+                        JS::PrivateValue(committed));
+  } else {
+    committed = static_cast<host_api::CommittedHeaders *>(committed_val.toPrivate());
+  }
+
+  auto res = host_api::write_headers(headers_handle, *list, committed);
   if (auto *err = res.to_err()) {
     HANDLE_ERROR(cx, *err);
     return false;
@@ -1202,6 +1697,19 @@ bool RequestOrResponse::commit_headers(JSContext *cx, HandleObject self) {
   return true;
 }
 
+void RequestOrResponse::free_committed_headers(JSObject *obj) {
+  JS::Value committed_val =
+      JS::GetReservedSlot(obj, static_cast<uint32_t>(Slots::CommittedHeaders));
+  if (!committed_val.isUndefined()) {
+    delete static_cast<host_api::CommittedHeaders *>(committed_val.toPrivate());
+  }
+}
+
+void RequestOrResponse::reset_committed_headers(JSObject *obj) {
+  free_committed_headers(obj);
+  JS::SetReservedSlot(obj, static_cast<uint32_t>(Slots::CommittedHeaders), JS::UndefinedValue());
+}
+
 bool RequestOrResponse::compare_bump_headers_gen(JSContext *cx, HandleObject self,
                                                  bool *changed_out) {
   RootedValue last_headers_gen(
@@ -1694,6 +2202,12 @@ bool RequestOrResponse::bodyAll(JSContext *cx, JS::CallArgs args, JS::HandleObje
     return true;
   }
 
+  // A body that `Request#clone` is still copying into can only be read through its stream, which
+  // waits for the copy to catch up.
+  if (!body_stream(self) && body_tee_pending(self) && !create_body_stream(cx, self)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
   if (!mark_body_used(cx, self)) {
 
     return ReturnPromiseRejectedWithPendingError(cx, args);
@@ -1753,6 +2267,9 @@ bool RequestOrResponse::body_source_pull_algorithm(JSContext *cx, JS::CallArgs a
 
   JS::RootedObject self(cx, &args.thisv().toObject());
   JS::RootedObject owner(cx, NativeStreamSource::owner(self));
+  if (body_tee_pending(owner)) {
+    start_body_tee(cx, owner);
+  }
 
   JS::RootedValue body_owner_value(cx, JS::ObjectValue(*body_owner));
   ENGINE->queue_async_task(new FastlyAsyncTask(RequestOrResponse::body_handle(owner).async_handle(),
@@ -1907,6 +2424,12 @@ bool RequestOrResponse::maybe_stream_body(JSContext *cx, JS::HandleObject body_o
                                           bool *requires_streaming) {
   JS::RootedObject stream(cx, RequestOrResponse::body_stream(body_owner));
   if (!stream) {
+    // A body that `Request#clone` is still copying into is sent as it's copied, and the send is
+    // finished once the copy is, see `finish_body_tee`.
+    *requires_streaming = body_tee_pending(body_owner);
+    if (*requires_streaming) {
+      start_body_tee(cx, body_owner);
+    }
     return true;
   }
 
@@ -1916,6 +2439,20 @@ bool RequestOrResponse::maybe_stream_body(JSContext *cx, JS::HandleObject body_o
     return false;
   }
 
+  // The same goes for such a body's own stream, as long as nothing has read from it.
+  if (body_tee_pending(body_owner)) {
+    JSObject *stream_source = NativeStreamSource::get_stream_source(cx, stream);
+    if (NativeStreamSource::is_instance(stream_source) &&
+        NativeStreamSource::owner(stream_source) == body_owner) {
+      if (!NativeStreamSource::lock_stream(cx, stream)) {
+        return false;
+      }
+      start_body_tee(cx, body_owner);
+      *requires_streaming = true;
+      return true;
+    }
+  }
+
   // If the body stream is backed by a Fastly Compute body handle, we can directly pipe
   // that handle into the body we're about to send.
   if (NativeStreamSource::stream_is_body(cx, stream)) {
@@ -1944,6 +2481,16 @@ bool RequestOrResponse::maybe_stream_body(JSContext *cx, JS::HandleObject body_o
     }
   }
 
+  // If the body is the readable end of an HTMLRewritingStream, have lol-html write its output
+  // straight into our body handle instead of enqueuing a chunk for every fragment. The reader
+  // below then only waits for the stream to close before the body is finished.
+  if (TransformStream::is_ts_readable(cx, stream)) {
+    JSObject *rewriter = owning_html_rewriter(TransformStream::ts_from_readable(cx, stream));
+    if (rewriter) {
+      html_rewriter::HTMLRewritingStream::write_output_to_body(rewriter, body_handle(body_owner));
+    }
+  }
+
   JS::RootedObject reader(
       cx, JS::ReadableStreamGetReader(cx, stream, JS::ReadableStreamReaderMode::Default));
   if (!reader)
@@ -2372,6 +2919,17 @@ bool Request::setManualFramingHeaders(JSContext *cx, unsigned argc, JS::Value *v
   return true;
 }
 
+bool Request::setMaxBodyChunkSize(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(1)
+
+  if (!set_max_body_chunk_size(cx, self, args[0], "Request.setMaxBodyChunkSize")) {
+    return false;
+  }
+
+  args.rval().setUndefined();
+  return true;
+}
+
 JSString *GET_atom;
 
 bool Request::clone(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -2421,64 +2979,75 @@ bool Request::clone(JSContext *cx, unsigned argc, JS::Value *vp) {
       return false;
     }
 
-    // Here we get the current requests body stream and call ReadableStream.prototype.tee to return
-    // two versions of the stream. Once we get the two streams, we create a new request handle and
-    // attach one of the streams to the new handle and the other stream is attached to the request
-    // handle that `clone()` was called upon.
-    JS::RootedObject body_stream(cx, RequestOrResponse::body_stream(self));
-    if (!body_stream) {
-      body_stream = RequestOrResponse::create_body_stream(cx, self);
+    if (!RequestOrResponse::body_stream(self) && !RequestOrResponse::body_tee_pending(self)) {
+      // Nothing has started streaming the host body yet, so it can be copied in the host. The
+      // clone and this request each get a body handle of their own, and both can still be handed
+      // to `fetch()` directly instead of having every chunk pass through JS via `tee()`. Once
+      // either request is read or sent, the copy runs in the background as the body arrives, see
+      // `process_body_tee`.
+      if (!prepare_body_tee(cx, self, requestInstance)) {
+        return false;
+      }
+    } else {
+      // Here we get the current requests body stream and call ReadableStream.prototype.tee to
+      // return two versions of the stream. Once we get the two streams, we create a new request
+      // handle and attach one of the streams to the new handle and the other stream is attached to
+      // the request handle that `clone()` was called upon.
+      JS::RootedObject body_stream(cx, RequestOrResponse::body_stream(self));
       if (!body_stream) {
+        body_stream = RequestOrResponse::create_body_stream(cx, self);
+        if (!body_stream) {
+          return false;
+        }
+      }
+      JS::RootedValue tee_val(cx);
+      if (!JS_GetProperty(cx, body_stream, "tee", &tee_val)) {
+        return false;
+      }
+      JS::Rooted<JSFunction *> tee(cx, JS_GetObjectFunction(&tee_val.toObject()));
+      if (!tee) {
+        return false;
+      }
+      JS::RootedVector<JS::Value> argv(cx);
+      JS::RootedValue rval(cx);
+      if (!JS::Call(cx, body_stream, tee, argv, &rval)) {
+        return false;
+      }
+      JS::RootedObject rval_array(cx, &rval.toObject());
+      JS::RootedValue body1_val(cx);
+      if (!JS_GetProperty(cx, rval_array, "0", &body1_val)) {
+        return false;
+      }
+      JS::RootedValue body2_val(cx);
+      if (!JS_GetProperty(cx, rval_array, "1", &body2_val)) {
         return false;
       }
-    }
-    JS::RootedValue tee_val(cx);
-    if (!JS_GetProperty(cx, body_stream, "tee", &tee_val)) {
-      return false;
-    }
-    JS::Rooted<JSFunction *> tee(cx, JS_GetObjectFunction(&tee_val.toObject()));
-    if (!tee) {
-      return false;
-    }
-    JS::RootedVector<JS::Value> argv(cx);
-    JS::RootedValue rval(cx);
-    if (!JS::Call(cx, body_stream, tee, argv, &rval)) {
-      return false;
-    }
-    JS::RootedObject rval_array(cx, &rval.toObject());
-    JS::RootedValue body1_val(cx);
-    if (!JS_GetProperty(cx, rval_array, "0", &body1_val)) {
-      return false;
-    }
-    JS::RootedValue body2_val(cx);
-    if (!JS_GetProperty(cx, rval_array, "1", &body2_val)) {
-      return false;
-    }
 
-    auto res = host_api::HttpBody::make();
-    if (auto *err = res.to_err()) {
-      HANDLE_ERROR(cx, *err);
-      return false;
-    }
+      auto res = host_api::HttpBody::make();
+      if (auto *err = res.to_err()) {
+        HANDLE_ERROR(cx, *err);
+        return false;
+      }
 
-    auto body_handle = res.unwrap();
-    if (!JS::IsReadableStream(&body1_val.toObject())) {
-      return false;
-    }
-    body_stream.set(&body1_val.toObject());
-    if (RequestOrResponse::body_unusable(cx, body_stream)) {
-      JS_ReportErrorNumberLatin1(cx, FastlyGetErrorMessage, nullptr,
-                                 JSMSG_READABLE_STREAM_LOCKED_OR_DISTRUBED);
-      return false;
-    }
+      auto body_handle = res.unwrap();
+      if (!JS::IsReadableStream(&body1_val.toObject())) {
+        return false;
+      }
+      body_stream.set(&body1_val.toObject());
+      if (RequestOrResponse::body_unusable(cx, body_stream)) {
+        JS_ReportErrorNumberLatin1(cx, FastlyGetErrorMessage, nullptr,
+                                   JSMSG_READABLE_STREAM_LOCKED_OR_DISTRUBED);
+        return false;
+      }
 
-    JS::SetReservedSlot(requestInstance, static_cast<uint32_t>(Slots::Body),
-                        JS::Int32Value(body_handle.handle));
-    JS::SetReservedSlot(requestInstance, static_cast<uint32_t>(Slots::BodyStream), body1_val);
+      JS::SetReservedSlot(requestInstance, static_cast<uint32_t>(Slots::Body),
+                          JS::Int32Value(body_handle.handle));
+      JS::SetReservedSlot(requestInstance, static_cast<uint32_t>(Slots::BodyStream), body1_val);
 
-    JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::BodyStream), body2_val);
-    JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::BodyUsed), JS::FalseValue());
-    JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::HasBody), JS::BooleanValue(true));
+      JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::BodyStream), body2_val);
+      JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::BodyUsed), JS::FalseValue());
+      JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::HasBody), JS::BooleanValue(true));
+    }
   }
 
   JS::RootedObject headers(cx, Request::headers(cx, self));
@@ -2714,6 +3283,7 @@ const JSFunctionSpec Request::methods[] = {
     JS_FN("setCacheOverride", Request::setCacheOverride, 3, JSPROP_ENUMERATE),
     JS_FN("setCacheKey", Request::setCacheKey, 0, JSPROP_ENUMERATE),
     JS_FN("setManualFramingHeaders", Request::setManualFramingHeaders, 1, JSPROP_ENUMERATE),
+    JS_FN("setMaxBodyChunkSize", Request::setMaxBodyChunkSize, 1, JSPROP_ENUMERATE),
     JS_FN("clone", Request::clone, 0, JSPROP_ENUMERATE),
     JS_FS_END,
 };
@@ -2880,7 +3450,11 @@ JSObject *Request::create(JSContext *cx, JS::HandleObject requestInstance, JS::H
     if (!url_instance)
       return nullptr;
 
-    JS::RootedObject parsedURL(cx, URL::create(cx, url_instance, input, fastly::Fastly::baseURL));
+    JS::RootedObject base_url(cx);
+    if (!fastly::Fastly::base_url(cx, &base_url)) {
+      return nullptr;
+    }
+    JS::RootedObject parsedURL(cx, URL::create(cx, url_instance, input, base_url));
 
     // 2.  If `parsedURL` is failure, then throw a `TypeError`.
     if (!parsedURL) {
@@ -3185,7 +3759,14 @@ JSObject *Request::create(JSContext *cx, JS::HandleObject requestInstance, JS::H
       return nullptr;
     }
 
-    if (!inputBody) {
+    if (!inputBody && RequestOrResponse::body_tee_pending(input_request)) {
+      // A body that `Request#clone` is still copying into can't be appended on the host side yet.
+      // Instead, the new request takes over the input request's part in the copy, so that it can
+      // still be sent without its body going through a stream.
+      if (!RequestOrResponse::move_body_tee(cx, input_request, request)) {
+        return nullptr;
+      }
+    } else if (!inputBody) {
       // If `inputBody` is null, that means that it was never created, and hence
       // content can't have access to it. Instead of reifying it here to pass it
       // into a TransformStream, we just append the body on the host side and
@@ -3309,6 +3890,10 @@ JSObject *Request::create_instance(JSContext *cx) {
   return requestInstance;
 }
 
+void Request::finalize(JS::GCContext *gcx, JSObject *self) {
+  RequestOrResponse::free_committed_headers(self);
+}
+
 bool Request::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
   REQUEST_HANDLER_ONLY("The Request builtin");
   CTOR_HEADER("Request", 1);
@@ -3866,14 +4451,68 @@ bool Response::redirect(JSContext *cx, unsigned argc, JS::Value *vp) {
 }
 
 namespace {
-bool callbackCalled;
-bool write_json_to_buf(const char16_t *str, uint32_t strlen, void *out) {
-  callbackCalled = true;
-  auto outstr = static_cast<std::u16string *>(out);
-  outstr->append(str, strlen);
+// Serializes JSON straight into a body. Each fragment JS::ToJSON produces is transcoded to UTF-8
+// into a fixed-size buffer that's written to the body whenever it fills up, so memory use doesn't
+// depend on the size of the payload.
+class JSONBodyWriter {
+public:
+  static constexpr size_t BUFFER_SIZE = 64 * 1024;
 
-  return true;
-}
+  JSONBodyWriter(host_api::HttpBody body, uint8_t *buf) : body_(body), buf_(buf) {}
+
+  static bool write(const char16_t *str, uint32_t len, void *data) {
+    return static_cast<JSONBodyWriter *>(data)->append(str, len);
+  }
+
+  bool finish() {
+    if (!reserve(common::Utf16ToUtf8::max_length(0))) {
+      return false;
+    }
+    len_ += transcoder_.finish(buf_ + len_);
+    return flush();
+  }
+
+  bool called() const { return called_; }
+  const std::optional<host_api::APIError> &error() const { return error_; }
+
+private:
+  host_api::HttpBody body_;
+  uint8_t *buf_;
+  size_t len_ = 0;
+  common::Utf16ToUtf8 transcoder_;
+  bool called_ = false;
+  std::optional<host_api::APIError> error_;
+
+  bool flush() {
+    if (len_ == 0) {
+      return true;
+    }
+    auto res = body_.write_all_back(buf_, len_);
+    if (auto *err = res.to_err()) {
+      error_ = *err;
+      return false;
+    }
+    len_ = 0;
+    return true;
+  }
+
+  bool reserve(size_t n) { return BUFFER_SIZE - len_ >= n || flush(); }
+
+  bool append(const char16_t *str, uint32_t len) {
+    called_ = true;
+    while (len > 0) {
+      if (!reserve(common::Utf16ToUtf8::max_length(1))) {
+        return false;
+      }
+      // As many code units as are sure to fit into the rest of the buffer.
+      size_t n = std::min<size_t>(len, (BUFFER_SIZE - len_ - 3) / 3);
+      len_ += transcoder_.transcode(str, n, buf_ + len_);
+      str += n;
+      len -= n;
+    }
+    return true;
+  }
+};
 } // namespace
 
 bool Response::json(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -3886,18 +4525,41 @@ bool Response::json(JSContext *cx, unsigned argc, JS::Value *vp) {
   JS::RootedObject replacer(cx);
   JS::RootedValue space(cx);
 
-  std::u16string out;
-  // 1. Let bytes the result of running serialize a JavaScript value to JSON bytes on data.
-  callbackCalled = false;
-  if (!JS::ToJSON(cx, data, replacer, space, &write_json_to_buf, &out)) {
+  auto make_res = host_api::HttpBody::make();
+  if (auto *err = make_res.to_err()) {
+    HANDLE_ERROR(cx, *err);
     return false;
   }
-  if (!callbackCalled) {
-    JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr,
-                              JSMSG_RESPONSE_JSON_INVALID_VALUE);
+  auto body = make_res.unwrap();
+  // Until the response has been returned, nothing else will use the body, so it's closed on
+  // every error path rather than leaked until the end of the request.
+  auto fail = [&body]() {
+    std::ignore = body.close();
     return false;
-  }
+  };
+
+  // 1. Let bytes the result of running serialize a JavaScript value to JSON bytes on data.
   // 2. Let body be the result of extracting bytes.
+  // The serialized JSON is written to the body as it's produced, instead of being collected into a
+  // string first.
+  {
+    host_api::HostcallArena::Scope scratch;
+    JSONBodyWriter writer(body, scratch.alloc(JSONBodyWriter::BUFFER_SIZE));
+    bool ok = JS::ToJSON(cx, data, replacer, space, &JSONBodyWriter::write, &writer) &&
+              writer.finish();
+    if (writer.error()) {
+      HANDLE_ERROR(cx, *writer.error());
+      return fail();
+    }
+    if (!ok) {
+      return fail();
+    }
+    if (!writer.called()) {
+      JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr,
+                                JSMSG_RESPONSE_JSON_INVALID_VALUE);
+      return fail();
+    }
+  }
 
   // 3. Let responseObject be the result of creating a Response object, given a new response,
   // "response", and this’s relevant Realm.
@@ -3913,79 +4575,63 @@ bool Response::json(JSContext *cx, unsigned argc, JS::Value *vp) {
     if (!JS_GetProperty(cx, init, "status", &status_val) ||
         !JS_GetProperty(cx, init, "statusText", &statusText_val) ||
         !JS_GetProperty(cx, init, "headers", &headers_val)) {
-      return false;
+      return fail();
     }
 
     if (!status_val.isUndefined() && !JS::ToUint16(cx, status_val, &status)) {
-      return false;
+      return fail();
     }
 
     if (status == 103 || status == 204 || status == 205 || status == 304) {
       JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr,
                                 JSMSG_RESPONSE_NULL_BODY_STATUS_WITH_BODY);
-      return false;
+      return fail();
     }
 
     if (!statusText_val.isUndefined() && !(statusText = JS::ToString(cx, statusText_val))) {
-      return false;
+      return fail();
     }
 
   } else if (!init_val.isNullOrUndefined()) {
     JS_ReportErrorLatin1(cx, "Response constructor: |init| parameter can't be converted to "
                              "a dictionary");
-    return false;
+    return fail();
   }
 
   auto response_handle_res = host_api::HttpResp::make();
   if (auto *err = response_handle_res.to_err()) {
     HANDLE_ERROR(cx, *err);
-    return false;
+    return fail();
   }
 
   auto response_handle = response_handle_res.unwrap();
   if (!response_handle.is_valid()) {
-    return false;
-  }
-
-  auto make_res = host_api::HttpBody::make();
-  if (auto *err = make_res.to_err()) {
-    HANDLE_ERROR(cx, *err);
-    return false;
+    return fail();
   }
 
-  auto body = make_res.unwrap();
-  JS::RootedString string(cx, JS_NewUCStringCopyN(cx, out.c_str(), out.length()));
-  auto stringChars = core::encode(cx, string);
-
-  auto write_res =
-      body.write_all_back(reinterpret_cast<uint8_t *>(stringChars.begin()), stringChars.len);
-  if (auto *err = write_res.to_err()) {
-    HANDLE_ERROR(cx, *err);
-    return false;
-  }
   JS::RootedObject response_instance(
       cx, JS_NewObjectWithGivenProto(cx, &Response::class_, Response::proto_obj));
   if (!response_instance) {
-    return false;
+    return fail();
   }
   JS::RootedObject response(
       cx, create(cx, response_instance, response_handle, body, false, nullptr, nullptr, nullptr));
   if (!response) {
-    return false;
+    return fail();
   }
 
   // Set `this`’s `response`’s `status` to `init`["status"].
   auto set_res = response_handle.set_status(status);
   if (auto *err = set_res.to_err()) {
     HANDLE_ERROR(cx, *err);
-    return false;
+    return fail();
   }
   // To ensure that we really have the same status value as the host,
   // we always read it back here.
   auto get_res = response_handle.get_status();
   if (auto *err = get_res.to_err()) {
     HANDLE_ERROR(cx, *err);
-    return false;
+    return fail();
   }
   status = get_res.unwrap();
 
@@ -3999,11 +4645,11 @@ bool Response::json(JSContext *cx, unsigned argc, JS::Value *vp) {
   // `init`["headers"].
   JS::RootedObject headers(cx, Headers::create(cx, headers_val, Headers::HeadersGuard::Response));
   if (!headers) {
-    return false;
+    return fail();
   }
   // 4. Perform initialize a response given responseObject, init, and (body, "application/json").
   if (!Headers::set_valid_if_undefined(cx, headers, "content-type", "application/json")) {
-    return false;
+    return fail();
   }
   JS::SetReservedSlot(response, static_cast<uint32_t>(Slots::Headers), JS::ObjectValue(*headers));
   JS::SetReservedSlot(response, static_cast<uint32_t>(Slots::Redirected), JS::FalseValue());
@@ -4037,6 +4683,17 @@ bool Response::setManualFramingHeaders(JSContext *cx, unsigned argc, JS::Value *
   return true;
 }
 
+bool Response::setMaxBodyChunkSize(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(1)
+
+  if (!set_max_body_chunk_size(cx, self, args[0], "Response.setMaxBodyChunkSize")) {
+    return false;
+  }
+
+  args.rval().setUndefined();
+  return true;
+}
+
 const JSFunctionSpec Response::static_methods[] = {
     JS_FN("redirect", redirect, 1, JSPROP_ENUMERATE),
     JS_FN("json", json, 1, JSPROP_ENUMERATE),
@@ -4055,6 +4712,7 @@ const JSFunctionSpec Response::methods[] = {
     JS_FN("json", bodyAll<RequestOrResponse::BodyReadResult::JSON>, 0, JSPROP_ENUMERATE),
     JS_FN("text", bodyAll<RequestOrResponse::BodyReadResult::Text>, 0, JSPROP_ENUMERATE),
     JS_FN("setManualFramingHeaders", Response::setManualFramingHeaders, 1, JSPROP_ENUMERATE),
+    JS_FN("setMaxBodyChunkSize", Response::setMaxBodyChunkSize, 1, JSPROP_ENUMERATE),
     JS_FN("staleIfErrorAvailable", staleIfErrorAvailable, 0, JSPROP_ENUMERATE),
     JS_FS_END,
 };
@@ -5017,6 +5675,7 @@ JSObject *Response::create(JSContext *cx, HandleObject request, host_api::Respon
 }
 
 void Response::finalize(JS::GCContext *gcx, JSObject *self) {
+  RequestOrResponse::free_committed_headers(self);
   auto suggested_cache_write_options_val =
       JS::GetReservedSlot(self, static_cast<size_t>(Response::Slots::SuggestedCacheWriteOptions));
   if (!suggested_cache_write_options_val.isUndefined()) {
@@ -23,6 +23,14 @@ public:
     CacheEntry,
     SourceRequest, // Tracks the original Request when body is proxied via TransformStream
     FetchEvent,
+    BodyReadChunkSize,    // Chunk size for the next read of a host-backed body stream
+    BodyReadMaxChunkSize, // Largest chunk size for reads of the body stream, if lowered
+    CommittedHeaders,     // host_api::CommittedHeaders last written to the handle by commit_headers
+    BodyTeeSource,        // Handle of the body `Request#clone` is copying into this one's body
+    BodyTeeReader,        // Body stream source waiting for `Request#clone` to copy more data
+    BodyTeePeer,          // The other owner `Request#clone` copies into, until the copy starts
+    BodyTeeDone,          // Promise settled once `Request#clone` is done copying into the body
+    BodyTeeMovedTo,       // Object that took over this one's part in the copy `Request#clone` makes
     Count,
   };
 
@@ -33,8 +41,32 @@ public:
   static JSObject *body_stream(JSObject *obj);
   static JSObject *body_source(JSContext *cx, JS::HandleObject obj);
   static bool body_used(JSObject *obj);
+  /**
+   * Whether the body handle is still being filled by the copy `Request#clone` started. Until the
+   * copy is done, the handle can't be handed to the host as a complete body.
+   */
+  static bool body_tee_pending(JSObject *obj);
+  /**
+   * Returns a promise that is resolved once the copy `Request#clone` makes into the body is done,
+   * or rejected if the body couldn't be copied in full, starting the copy if needed. Must only be
+   * called while `body_tee_pending`.
+   */
+  static JSObject *body_tee_done(JSContext *cx, JS::HandleObject obj);
+  /**
+   * The most bytes a single read of the body's stream asks the host for. Defaults to
+   * `host_api::BodyReadSizer::MAX_CHUNK_SIZE`, and can be lowered per body with
+   * `setMaxBodyChunkSize`.
+   */
+  static size_t max_body_chunk_size(JSObject *obj);
+  static bool set_max_body_chunk_size(JSContext *cx, JS::HandleObject self, JS::HandleValue size,
+                                      const char *method);
   static bool mark_body_used(JSContext *cx, JS::HandleObject obj);
   static bool move_body_handle(JSContext *cx, JS::HandleObject from, JS::HandleObject to);
+  /**
+   * Like `move_body_handle`, for a body `Request#clone` is still copying into and that has no
+   * stream. `to` takes over `from`'s part in the copy, so that its body can still be sent directly.
+   */
+  static bool move_body_tee(JSContext *cx, JS::HandleObject from, JS::HandleObject to);
   static JS::Value url(JSObject *obj);
   static void set_url(JSObject *obj, JS::Value url);
   static void set_manual_framing_headers(JSContext *cx, JSObject *obj, JS::HandleValue url);
@@ -55,6 +87,17 @@ public:
    */
   static bool commit_headers(JSContext *cx, JS::HandleObject self);
 
+  /**
+   * Frees the record of committed headers kept by `commit_headers`. Called on finalization.
+   */
+  static void free_committed_headers(JSObject *obj);
+
+  /**
+   * Forgets the record of committed headers, so that the next `commit_headers` writes all headers.
+   * Must be called whenever the object's host handle is replaced with a different one.
+   */
+  static void reset_committed_headers(JSObject *obj);
+
   /**
    * Compare the HeadersGen slot with the current headers generation, returning true if the headers
    * have changed and false otherwise, storing the new generation into the slot.
@@ -139,7 +182,7 @@ public:
   static bool close_if_cache_entry(JSContext *cx, JS::HandleObject self);
 };
 
-class Request final : public builtins::BuiltinImpl<Request> {
+class Request final : public builtins::FinalizableBuiltinImpl<Request> {
   static bool method_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool headers_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool url_get(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -156,6 +199,7 @@ class Request final : public builtins::BuiltinImpl<Request> {
   static bool setCacheOverride(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool setCacheKey(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool setManualFramingHeaders(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool setMaxBodyChunkSize(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool clone(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool bot_analyzed_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool bot_detected_get(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -229,6 +273,8 @@ public:
                           JS::HandleValue init_val);
 
   static JSObject *create_instance(JSContext *cx);
+
+  static void finalize(JS::GCContext *gcx, JSObject *self);
 };
 
 class Response final : public builtins::FinalizableBuiltinImpl<Response> {
@@ -255,6 +301,7 @@ class Response final : public builtins::FinalizableBuiltinImpl<Response> {
   static bool redirect(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool json(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool setManualFramingHeaders(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool setMaxBodyChunkSize(JSContext *cx, unsigned argc, JS::Value *vp);
 
 public:
   static constexpr const char *class_name = "Response";
@@ -3,7 +3,10 @@
 #include "../../../StarlingMonkey/builtins/web/streams/transform-stream.h"
 #include "../../../StarlingMonkey/runtime/encode.h"
 #include "../host-api/host_api_fastly.h"
+#include <cmath>
 #include <lol_html.h>
+#include <string>
+#include <unordered_map>
 
 using builtins::web::streams::TransformStream;
 using builtins::web::streams::TransformStreamDefaultController;
@@ -277,10 +280,15 @@ static void set_raw_rewriter(JSObject *self, lol_html_rewriter_t *rewriter) {
 class ElementHandlerData {
 public:
   ElementHandlerData(JSContext *cx, JSObject *handler, JSString *js_selector,
-                     lol_html_selector_t *raw_selector)
-      : cx_(cx), handler_(handler), js_selector_(js_selector), raw_selector_(raw_selector) {}
+                     lol_html_selector_t *raw_selector, bool owns_selector)
+      : cx_(cx), handler_(handler), js_selector_(js_selector), raw_selector_(raw_selector),
+        owns_selector_(owns_selector) {}
 
-  ~ElementHandlerData() { lol_html_selector_free(raw_selector_); }
+  ~ElementHandlerData() {
+    if (owns_selector_) {
+      lol_html_selector_free(raw_selector_);
+    }
+  }
 
   JSContext *cx() const { return cx_; }
   JSObject *handler() const { return handler_; }
@@ -296,8 +304,34 @@ private:
   JS::Heap<JSObject *> handler_;
   JS::Heap<JSString *> js_selector_;
   lol_html_selector_t *raw_selector_;
+  // Selectors taken from the selector cache are shared, and must outlive this handler.
+  bool owns_selector_;
 };
 
+// Parsed selectors, keyed by their source text. A parsed selector can be used by any number of
+// rewriters, so these are kept for the lifetime of the sandbox: a reused sandbox then doesn't
+// re-parse the same rewrite configuration for every request.
+std::unordered_map<std::string, lol_html_selector_t *> selector_cache;
+constexpr size_t SELECTOR_CACHE_MAX_ENTRIES = 256;
+
+// Returns the parsed selector and whether the caller owns it, or nullptr if parsing failed.
+static std::pair<lol_html_selector_t *, bool> parse_selector(std::string_view selector) {
+  auto cached = selector_cache.find(std::string(selector));
+  if (cached != selector_cache.end()) {
+    return {cached->second, false};
+  }
+
+  auto raw_selector = lol_html_selector_parse(selector.data(), selector.size());
+  if (!raw_selector) {
+    return {nullptr, false};
+  }
+  if (selector_cache.size() >= SELECTOR_CACHE_MAX_ENTRIES) {
+    return {raw_selector, true};
+  }
+  selector_cache.emplace(selector, raw_selector);
+  return {raw_selector, false};
+}
+
 // Called by lol_html when an element matching a registered selector is found
 static lol_html_rewriter_directive_t handle_element(lol_html_element_t *element, void *user_data) {
   auto *data = static_cast<ElementHandlerData *>(user_data);
@@ -318,27 +352,22 @@ static lol_html_rewriter_directive_t handle_element(lol_html_element_t *element,
   return LOL_HTML_CONTINUE;
 }
 
-bool HTMLRewritingStream::onElement(JSContext *cx, unsigned argc, JS::Value *vp) {
-  METHOD_HEADER(2)
-
-  if (!builder(self)) {
-    JS_ReportErrorASCII(cx, "HTMLRewriter: cannot add handlers after the rewriter has been used");
-    return false;
-  }
-
-  JS::HandleValue selector_arg = args.get(0);
+// Registers `handler` for elements matching `selector_arg` on `builder`, adding its handler data to
+// `element_handlers`, which owns it from then on.
+static bool add_element_handler(JSContext *cx, lol_html_rewriter_builder_t *builder,
+                                std::vector<ElementHandlerData *> *element_handlers,
+                                JS::HandleValue selector_arg, JS::HandleValue handler) {
   auto selector_str = core::encode(cx, selector_arg);
   if (!selector_str) {
     return false;
   }
 
-  JS::HandleValue handler = args.get(1);
   if (!handler.isObject() || !JS_ObjectIsFunction(&handler.toObject())) {
     JS_ReportErrorASCII(cx, "HTMLRewriter: element handler must be a function");
     return false;
   }
 
-  auto raw_selector = lol_html_selector_parse(selector_str.begin(), selector_str.size());
+  auto [raw_selector, owns_selector] = parse_selector(selector_str);
   if (!raw_selector) {
     auto error = lol_html_take_last_error();
     if (error.data) {
@@ -351,20 +380,85 @@ bool HTMLRewritingStream::onElement(JSContext *cx, unsigned argc, JS::Value *vp)
     return false;
   }
   // Create a unique_ptr so we don't leak if we error out below
-  auto handler_data = std::make_unique<ElementHandlerData>(cx, &handler.toObject(),
-                                                           selector_arg.toString(), raw_selector);
+  auto handler_data = std::make_unique<ElementHandlerData>(
+      cx, &handler.toObject(), selector_arg.toString(), raw_selector, owns_selector);
 
   if (lol_html_rewriter_builder_add_element_content_handlers(
-          builder(self), raw_selector, handle_element, handler_data.get(), nullptr, nullptr,
-          nullptr, nullptr) != 0) {
+          builder, raw_selector, handle_element, handler_data.get(), nullptr, nullptr, nullptr,
+          nullptr) != 0) {
     return false;
   }
 
-  // This slot holds all element handlers so we can free them when the stream is finalized.
-  // This will also free the lol-html selectors.
-  auto element_handlers = static_cast<std::vector<ElementHandlerData *> *>(
-      JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::ElementHandlers)).toPrivate());
   element_handlers->push_back(handler_data.release());
+  return true;
+}
+
+static std::vector<ElementHandlerData *> *element_handlers(JSObject *self, uint32_t slot) {
+  return static_cast<std::vector<ElementHandlerData *> *>(
+      JS::GetReservedSlot(self, slot).toPrivate());
+}
+
+static void free_element_handlers(JSObject *self, uint32_t slot) {
+  auto handlers_val = JS::GetReservedSlot(self, slot);
+  if (handlers_val.isUndefined()) {
+    return;
+  }
+  auto handlers = static_cast<std::vector<ElementHandlerData *> *>(handlers_val.toPrivate());
+  if (handlers) {
+    for (auto handler : *handlers) {
+      delete handler;
+    }
+    delete handlers;
+  }
+}
+
+static void trace_element_handlers(JSTracer *trc, JSObject *self, uint32_t slot) {
+  auto handlers_val = JS::GetReservedSlot(self, slot);
+  if (handlers_val.isUndefined()) {
+    return;
+  }
+  auto handlers = static_cast<std::vector<ElementHandlerData *> *>(handlers_val.toPrivate());
+  if (handlers) {
+    for (auto *handler : *handlers) {
+      handler->trace(trc);
+    }
+  }
+}
+
+static JSObject *stream_template(JSObject *self) {
+  MOZ_ASSERT(HTMLRewritingStream::is_instance(self));
+  auto template_val = JS::GetReservedSlot(self, HTMLRewritingStream::Slots::Template);
+  return template_val.isObject() ? &template_val.toObject() : nullptr;
+}
+
+static lol_html_rewriter_builder_t *template_builder(JSObject *self) {
+  MOZ_ASSERT(HTMLRewritingStreamTemplate::is_instance(self));
+  return static_cast<lol_html_rewriter_builder_t *>(
+      JS::GetReservedSlot(self,
+                          static_cast<uint32_t>(HTMLRewritingStreamTemplate::Slots::RawBuilder))
+          .toPrivate());
+}
+
+bool HTMLRewritingStream::onElement(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(2)
+
+  if (stream_template(self)) {
+    JS_ReportErrorASCII(cx, "HTMLRewriter: cannot add handlers to a stream created from a "
+                            "template");
+    return false;
+  }
+
+  if (!builder(self)) {
+    JS_ReportErrorASCII(cx, "HTMLRewriter: cannot add handlers after the rewriter has been used");
+    return false;
+  }
+
+  // This slot holds all element handlers so we can free them when the stream is finalized.
+  // This will also free the lol-html selectors that aren't cached.
+  if (!add_element_handler(cx, builder(self), element_handlers(self, Slots::ElementHandlers),
+                           args.get(0), args.get(1))) {
+    return false;
+  }
 
   args.rval().setObject(*self);
   return true;
@@ -374,6 +468,9 @@ struct OutputContextData {
   JSContext *cx;
   JS::Heap<JSObject *> self;
   bool enqueue_failed;
+  // When set, output is appended to this body instead of being enqueued on the readable side.
+  std::optional<host_api::HttpBody> body;
+  std::optional<host_api::APIError> write_error;
 
   OutputContextData(JSContext *cx, JSObject *self) : cx(cx), self(self), enqueue_failed(false) {}
 
@@ -387,14 +484,7 @@ void HTMLRewritingStream::finalize(JS::GCContext *gcx, JSObject *self) {
     lol_html_rewriter_builder_free(static_cast<lol_html_rewriter_builder_t *>(build));
   }
 
-  auto element_handlers = static_cast<std::vector<ElementHandlerData *> *>(
-      JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::ElementHandlers)).toPrivate());
-  if (element_handlers) {
-    for (auto handler : *element_handlers) {
-      delete handler;
-    }
-    delete element_handlers;
-  }
+  free_element_handlers(self, Slots::ElementHandlers);
 
   auto output_context = static_cast<OutputContextData *>(
       JS::GetReservedSlot(self, HTMLRewritingStream::Slots::OutputContext).toPrivate());
@@ -411,17 +501,7 @@ void HTMLRewritingStream::finalize(JS::GCContext *gcx, JSObject *self) {
 void HTMLRewritingStream::trace(JSTracer *trc, JSObject *self) {
   MOZ_ASSERT(is_instance(self));
 
-  auto element_handlers_val =
-      JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::ElementHandlers));
-  if (!element_handlers_val.isUndefined()) {
-    auto element_handlers =
-        static_cast<std::vector<ElementHandlerData *> *>(element_handlers_val.toPrivate());
-    if (element_handlers) {
-      for (auto *handler : *element_handlers) {
-        handler->trace(trc);
-      }
-    }
-  }
+  trace_element_handlers(trc, self, Slots::ElementHandlers);
 
   auto output_context_val = JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::OutputContext));
   if (!output_context_val.isUndefined()) {
@@ -434,6 +514,17 @@ void HTMLRewritingStream::trace(JSTracer *trc, JSObject *self) {
 
 static void output_callback(const char *chunk, size_t chunk_len, void *user_data) {
   auto *ctx = static_cast<OutputContextData *>(user_data);
+  if (ctx->body) {
+    if (ctx->write_error) {
+      return;
+    }
+    auto res = ctx->body->write_all_back(reinterpret_cast<const uint8_t *>(chunk), chunk_len);
+    if (auto *err = res.to_err()) {
+      ctx->write_error = *err;
+    }
+    return;
+  }
+
   JSContext *cx = ctx->cx;
   JS::RootedObject self(cx, ctx->self);
 
@@ -466,13 +557,35 @@ bool HTMLRewritingStream::finish_building(JSContext *cx, JS::HandleObject stream
   // The output callback needs the JSContext and the stream object so it can enqueue into output
   // stream. We use a unique_ptr to ensure we don't leak if something fails.
   auto output_context = std::make_unique<OutputContextData>(cx, stream);
-  // Same defaults as Rust
+  auto output_body = JS::GetReservedSlot(stream, HTMLRewritingStream::Slots::OutputBody);
+  if (output_body.isInt32()) {
+    output_context->body.emplace(output_body.toInt32());
+  }
+  // Same defaults as Rust, unless overridden by the constructor's options
   lol_html_memory_settings_t memory_settings = {1024, std::numeric_limits<size_t>::max()};
+  auto preallocated = JS::GetReservedSlot(stream, Slots::PreallocatedParsingBufferSize);
+  if (preallocated.isNumber()) {
+    memory_settings.preallocated_parsing_buffer_size = static_cast<size_t>(preallocated.toNumber());
+  }
+  auto max_memory = JS::GetReservedSlot(stream, Slots::MaxAllowedMemoryUsage);
+  if (max_memory.isNumber()) {
+    memory_settings.max_allowed_memory_usage = static_cast<size_t>(max_memory.toNumber());
+  }
+  // Streams created from a template share the template's builder, which stays with the template.
+  JS::RootedObject tmpl(cx, stream_template(stream));
+  auto *build = tmpl ? template_builder(tmpl) : builder(stream);
   auto encoding_string_length = 5; // "utf-8"
-  auto rewriter =
-      lol_html_rewriter_build(builder(stream), "utf-8", encoding_string_length, memory_settings,
-                              output_callback, output_context.get(), true);
+  auto rewriter = lol_html_rewriter_build(build, "utf-8", encoding_string_length, memory_settings,
+                                          output_callback, output_context.get(), true);
   if (!rewriter) {
+    auto err = lol_html_take_last_error();
+    if (err.data) {
+      // Error may not be null-terminated
+      JS_ReportErrorASCII(cx, "HTMLRewriter: failed to create rewriter - %s",
+                          std::string(err.data, err.len).c_str());
+    } else {
+      JS_ReportErrorASCII(cx, "HTMLRewriter: failed to create rewriter");
+    }
     return false;
   }
 
@@ -481,35 +594,71 @@ bool HTMLRewritingStream::finish_building(JSContext *cx, JS::HandleObject stream
   set_raw_rewriter(stream, rewriter);
 
   // The builder is no longer needed after building the rewriter and can be safely freed
-  lol_html_rewriter_builder_free(builder(stream));
-  set_builder(stream, nullptr); // Ensure we don't try to free it again in finalize
+  if (!tmpl) {
+    lol_html_rewriter_builder_free(builder(stream));
+    set_builder(stream, nullptr); // Ensure we don't try to free it again in finalize
+  }
 
   return true;
 }
 
-bool HTMLRewritingStream::transformAlgorithm(JSContext *cx, unsigned argc, JS::Value *vp) {
-  METHOD_HEADER_WITH_NAME(1, "HTML rewriter transform algorithm")
+bool HTMLRewritingStream::write_output_to_body(JSObject *stream, host_api::HttpBody body) {
+  MOZ_ASSERT(is_instance(stream));
+  // Once the rewriter exists it may already have enqueued output, which would then end up
+  // behind anything written to the body directly.
+  if (raw_rewriter(stream)) {
+    return false;
+  }
+  JS::SetReservedSlot(stream, Slots::OutputBody, JS::Int32Value(body.handle));
+  return true;
+}
 
-  if (!raw_rewriter(self)) {
-    HTMLRewritingStream::finish_building(cx, self);
+bool HTMLRewritingStream::start_native_input(JSObject *stream) {
+  MOZ_ASSERT(is_instance(stream));
+  if (native_input(stream)) {
+    return true;
+  }
+  // Input that already went through the writable side may still be buffered in lol-html, and
+  // anything fed in natively has to come after it.
+  if (raw_rewriter(stream)) {
+    return false;
   }
+  JS::SetReservedSlot(stream, Slots::NativeInput, JS::TrueValue());
+  return true;
+}
 
-  auto rewriter = raw_rewriter(self);
-  MOZ_ASSERT(rewriter);
+bool HTMLRewritingStream::native_input(JSObject *stream) {
+  MOZ_ASSERT(is_instance(stream));
+  return JS::GetReservedSlot(stream, Slots::NativeInput).isTrue();
+}
 
-  auto chunk = args.get(0);
-  auto data = value_to_buffer(cx, chunk, "HTMLRewritingStream transform: chunks");
-  if (!data.has_value()) {
+JSObject *HTMLRewritingStream::output_backpressure(JSObject *stream) {
+  MOZ_ASSERT(is_instance(stream));
+  if (JS::GetReservedSlot(stream, Slots::OutputBody).isInt32()) {
+    return nullptr;
+  }
+  JSObject *ts = transform(stream);
+  return TransformStream::backpressure(ts) ? TransformStream::backpressureChangePromise(ts)
+                                           : nullptr;
+}
+
+bool HTMLRewritingStream::write_input(JSContext *cx, JS::HandleObject stream, const uint8_t *data,
+                                      size_t len) {
+  MOZ_ASSERT(is_instance(stream));
+  if (!raw_rewriter(stream) && !HTMLRewritingStream::finish_building(cx, stream)) {
     return false;
   }
 
-  if (data->size() == 0) {
+  auto rewriter = raw_rewriter(stream);
+  MOZ_ASSERT(rewriter);
+
+  if (len == 0) {
     return true;
   }
 
   lol_html_take_last_error(); // Clear any previous error
   // lol-html will call output_callback with the processed data
-  lol_html_rewriter_write(rewriter, reinterpret_cast<const char *>(data->data()), data->size());
+  lol_html_rewriter_write(rewriter, reinterpret_cast<const char *>(data), len);
   auto err = lol_html_take_last_error();
   if (err.data) {
     // Error may not be null-terminated
@@ -518,11 +667,31 @@ bool HTMLRewritingStream::transformAlgorithm(JSContext *cx, unsigned argc, JS::V
   }
 
   auto output_context = static_cast<OutputContextData *>(
-      JS::GetReservedSlot(self, HTMLRewritingStream::Slots::OutputContext).toPrivate());
+      JS::GetReservedSlot(stream, HTMLRewritingStream::Slots::OutputContext).toPrivate());
   if (output_context->enqueue_failed) {
     JS_ReportErrorASCII(cx, "Error processing HTML: output stream enqueue failed");
     return false;
   }
+  if (output_context->write_error) {
+    HANDLE_ERROR(cx, *output_context->write_error);
+    return false;
+  }
+
+  return true;
+}
+
+bool HTMLRewritingStream::transformAlgorithm(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER_WITH_NAME(1, "HTML rewriter transform algorithm")
+
+  auto chunk = args.get(0);
+  auto data = value_to_buffer(cx, chunk, "HTMLRewritingStream transform: chunks");
+  if (!data.has_value()) {
+    return false;
+  }
+
+  if (!write_input(cx, self, data->data(), data->size())) {
+    return false;
+  }
 
   args.rval().setUndefined();
   return true;
@@ -532,8 +701,8 @@ bool HTMLRewritingStream::flushAlgorithm(JSContext *cx, unsigned argc, JS::Value
   METHOD_HEADER_WITH_NAME(0, "HTML rewriter flush algorithm")
 
   // Just in case the stream is flushed immediately
-  if (!raw_rewriter(self)) {
-    HTMLRewritingStream::finish_building(cx, self);
+  if (!raw_rewriter(self) && !HTMLRewritingStream::finish_building(cx, self)) {
+    return false;
   }
 
   auto rewriter = raw_rewriter(self);
@@ -549,6 +718,13 @@ bool HTMLRewritingStream::flushAlgorithm(JSContext *cx, unsigned argc, JS::Value
     return false;
   }
 
+  auto output_context = static_cast<OutputContextData *>(
+      JS::GetReservedSlot(self, HTMLRewritingStream::Slots::OutputContext).toPrivate());
+  if (output_context->write_error) {
+    HANDLE_ERROR(cx, *output_context->write_error);
+    return false;
+  }
+
   args.rval().setUndefined();
   return true;
 }
@@ -565,25 +741,70 @@ bool HTMLRewritingStream::writable_get(JSContext *cx, unsigned argc, JS::Value *
   return true;
 }
 
+// Reads an optional non-negative integer option, leaving `out` undefined if it isn't present.
+static bool get_size_option(JSContext *cx, JS::HandleObject options, const char *name,
+                            JS::MutableHandleValue out) {
+  JS::RootedValue val(cx);
+  if (!JS_GetProperty(cx, options, name, &val)) {
+    return false;
+  }
+  if (val.isUndefined()) {
+    out.setUndefined();
+    return true;
+  }
+  if (!val.isNumber() || val.toNumber() < 0 || std::floor(val.toNumber()) != val.toNumber() ||
+      val.toNumber() > static_cast<double>(std::numeric_limits<size_t>::max())) {
+    JS_ReportErrorASCII(cx, "HTMLRewritingStream: %s must be a non-negative integer", name);
+    return false;
+  }
+  out.setNumber(val.toNumber());
+  return true;
+}
+
 JS::PersistentRooted<JSObject *> transformAlgo;
 JS::PersistentRooted<JSObject *> flushAlgo;
 
-bool HTMLRewritingStream::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
-  CTOR_HEADER("HTMLRewritingStream", 0)
-
-  JS::RootedObject instance(cx, JS_NewObjectForConstructor(cx, &class_, args));
-  if (!instance) {
-    return false;
-  }
-  auto builder = lol_html_rewriter_builder_new();
-  if (!builder) {
+// Reads the memory settings from an HTMLRewritingStream options argument.
+static bool read_memory_settings(JSContext *cx, JS::HandleValue options_arg,
+                                 JS::MutableHandleValue preallocated,
+                                 JS::MutableHandleValue max_memory) {
+  if (options_arg.isObject()) {
+    JS::RootedObject options(cx, &options_arg.toObject());
+    if (!get_size_option(cx, options, "preallocatedParsingBufferSize", &preallocated) ||
+        !get_size_option(cx, options, "maxAllowedMemoryUsage", &max_memory)) {
+      return false;
+    }
+    if (preallocated.isNumber() && max_memory.isNumber() &&
+        preallocated.toNumber() > max_memory.toNumber()) {
+      JS_ReportErrorASCII(cx, "HTMLRewritingStream: preallocatedParsingBufferSize must not exceed "
+                              "maxAllowedMemoryUsage");
+      return false;
+    }
+  } else if (!options_arg.isUndefined()) {
+    JS_ReportErrorASCII(cx, "HTMLRewritingStream: options must be an object");
     return false;
   }
+  return true;
+}
+
+// Initializes a newly allocated stream. Streams created from a template have no builder of their
+// own, and get their memory settings from the template.
+static bool init_stream(JSContext *cx, JS::HandleObject instance,
+                        lol_html_rewriter_builder_t *builder, JS::HandleValue preallocated,
+                        JS::HandleValue max_memory, JS::HandleObject tmpl) {
+  using Slots = HTMLRewritingStream::Slots;
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::PreallocatedParsingBufferSize),
+                      preallocated);
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::MaxAllowedMemoryUsage), max_memory);
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::Template),
+                      tmpl ? JS::ObjectValue(*tmpl) : JS::UndefinedValue());
   set_builder(instance, builder);
   // We have no rewriter initially; it will be created on the first chunk processed
   set_raw_rewriter(instance, nullptr);
   JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::OutputContext),
                       JS::PrivateValue(nullptr));
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::OutputBody), JS::UndefinedValue());
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::NativeInput), JS::FalseValue());
   JS::RootedValue stream_val(cx, JS::ObjectValue(*instance));
   JS::RootedObject transform(cx, TransformStream::create(cx, 1, nullptr, 0, nullptr, stream_val,
                                                          nullptr, transformAlgo, flushAlgo));
@@ -596,11 +817,127 @@ bool HTMLRewritingStream::constructor(JSContext *cx, unsigned argc, JS::Value *v
 
   JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::ElementHandlers),
                       JS::PrivateValue(new std::vector<ElementHandlerData *>()));
+  return true;
+}
+
+bool HTMLRewritingStream::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
+  CTOR_HEADER("HTMLRewritingStream", 0)
+
+  JS::RootedValue preallocated(cx);
+  JS::RootedValue max_memory(cx);
+  if (!read_memory_settings(cx, args.get(0), &preallocated, &max_memory)) {
+    return false;
+  }
+
+  JS::RootedObject instance(cx, JS_NewObjectForConstructor(cx, &class_, args));
+  if (!instance) {
+    return false;
+  }
+  auto builder = lol_html_rewriter_builder_new();
+  if (!builder) {
+    return false;
+  }
+  if (!init_stream(cx, instance, builder, preallocated, max_memory, nullptr)) {
+    return false;
+  }
 
   args.rval().setObject(*instance);
   return true;
 }
 
+const JSFunctionSpec HTMLRewritingStreamTemplate::static_methods[] = {JS_FS_END};
+const JSPropertySpec HTMLRewritingStreamTemplate::static_properties[] = {JS_PS_END};
+const JSFunctionSpec HTMLRewritingStreamTemplate::methods[] = {
+    JS_FN("onElement", onElement, 2, JSPROP_ENUMERATE),
+    JS_FN("createStream", createStream, 0, JSPROP_ENUMERATE), JS_FS_END};
+const JSPropertySpec HTMLRewritingStreamTemplate::properties[] = {JS_PS_END};
+
+bool HTMLRewritingStreamTemplate::onElement(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(2)
+
+  if (JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::Used)).isTrue()) {
+    JS_ReportErrorASCII(cx, "HTMLRewriter: cannot add handlers to a template after streams have "
+                            "been created from it");
+    return false;
+  }
+
+  if (!add_element_handler(cx, template_builder(self),
+                           element_handlers(self, Slots::ElementHandlers), args.get(0),
+                           args.get(1))) {
+    return false;
+  }
+
+  args.rval().setObject(*self);
+  return true;
+}
+
+bool HTMLRewritingStreamTemplate::createStream(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0)
+
+  JS::RootedObject instance(cx, JS_NewObjectWithGivenProto(cx, &HTMLRewritingStream::class_,
+                                                           HTMLRewritingStream::proto_obj));
+  if (!instance) {
+    return false;
+  }
+  JS::RootedValue preallocated(
+      cx, JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::PreallocatedParsingBufferSize)));
+  JS::RootedValue max_memory(
+      cx, JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::MaxAllowedMemoryUsage)));
+  if (!init_stream(cx, instance, nullptr, preallocated, max_memory, self)) {
+    return false;
+  }
+  // Rewriters already built from the builder wouldn't see handlers added from now on, so the
+  // template's set of handlers is fixed from here.
+  JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::Used), JS::TrueValue());
+
+  args.rval().setObject(*instance);
+  return true;
+}
+
+bool HTMLRewritingStreamTemplate::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
+  CTOR_HEADER("HTMLRewritingStreamTemplate", 0)
+
+  JS::RootedValue preallocated(cx);
+  JS::RootedValue max_memory(cx);
+  if (!read_memory_settings(cx, args.get(0), &preallocated, &max_memory)) {
+    return false;
+  }
+
+  JS::RootedObject instance(cx, JS_NewObjectForConstructor(cx, &class_, args));
+  if (!instance) {
+    return false;
+  }
+  auto builder = lol_html_rewriter_builder_new();
+  if (!builder) {
+    return false;
+  }
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::RawBuilder),
+                      JS::PrivateValue(builder));
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::ElementHandlers),
+                      JS::PrivateValue(new std::vector<ElementHandlerData *>()));
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::PreallocatedParsingBufferSize),
+                      preallocated);
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::MaxAllowedMemoryUsage), max_memory);
+  JS::SetReservedSlot(instance, static_cast<uint32_t>(Slots::Used), JS::FalseValue());
+
+  args.rval().setObject(*instance);
+  return true;
+}
+
+void HTMLRewritingStreamTemplate::finalize(JS::GCContext *gcx, JSObject *self) {
+  MOZ_ASSERT(is_instance(self));
+  auto build = JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::RawBuilder));
+  if (!build.isUndefined() && build.toPrivate()) {
+    lol_html_rewriter_builder_free(static_cast<lol_html_rewriter_builder_t *>(build.toPrivate()));
+  }
+  free_element_handlers(self, Slots::ElementHandlers);
+}
+
+void HTMLRewritingStreamTemplate::trace(JSTracer *trc, JSObject *self) {
+  MOZ_ASSERT(is_instance(self));
+  trace_element_handlers(trc, self, Slots::ElementHandlers);
+}
+
 bool HTMLRewritingStream::init_class(JSContext *cx, JS::HandleObject global) {
   if (!init_class_impl(cx, global)) {
     return false;
@@ -629,6 +966,10 @@ bool install(api::Engine *engine) {
     return false;
   }
 
+  if (!HTMLRewritingStreamTemplate::init_class_impl(engine->cx(), engine->global())) {
+    return false;
+  }
+
   RootedObject html_rewriter_obj(
       engine->cx(),
       JS_GetConstructor(engine->cx(), builtins::BuiltinImpl<HTMLRewritingStream>::proto_obj));
@@ -637,6 +978,15 @@ bool install(api::Engine *engine) {
   if (!JS_SetProperty(engine->cx(), html_rewriter_ns, "HTMLRewritingStream", html_rewriter_val)) {
     return false;
   }
+  RootedObject template_obj(
+      engine->cx(),
+      JS_GetConstructor(engine->cx(),
+                        builtins::BuiltinImpl<HTMLRewritingStreamTemplate>::proto_obj));
+  RootedValue template_val(engine->cx(), ObjectValue(*template_obj));
+  if (!JS_SetProperty(engine->cx(), html_rewriter_ns, "HTMLRewritingStreamTemplate",
+                      template_val)) {
+    return false;
+  }
   RootedValue html_rewriter_ns_val(engine->cx(), JS::ObjectValue(*html_rewriter_ns));
   if (!engine->define_builtin_module("fastly:html-rewriter", html_rewriter_ns_val)) {
     return false;
@@ -43,7 +43,20 @@ private:
 public:
   static constexpr const char *class_name = "HTMLRewritingStream";
   static const int ctor_length = 0;
-  enum Slots { RawBuilder, RawRewriter, Buffer, OutputContext, ElementHandlers, Transform, Count };
+  enum Slots {
+    RawBuilder,
+    RawRewriter,
+    Buffer,
+    OutputContext,
+    ElementHandlers,
+    Transform,
+    OutputBody,
+    NativeInput,
+    PreallocatedParsingBufferSize,
+    MaxAllowedMemoryUsage,
+    Template,
+    Count
+  };
   static const JSFunctionSpec static_methods[];
   static const JSPropertySpec static_properties[];
   static const JSFunctionSpec methods[];
@@ -55,9 +68,67 @@ public:
   static bool onElement(JSContext *cx, unsigned argc, JS::Value *vp);
 
   static bool finish_building(JSContext *cx, JS::HandleObject stream);
+
+  /**
+   * Have the rewriter write its output directly into `body` instead of enqueuing it on its
+   * readable side. This is only possible before the rewriter has produced any output; returns
+   * whether the body was attached.
+   */
+  static bool write_output_to_body(JSObject *stream, host_api::HttpBody body);
+
+  /**
+   * Switch the rewriter over to being fed by `write_input` from a host body that is piped into
+   * it, bypassing its writable side. Only possible before any input has been transformed;
+   * returns whether the switch was made.
+   */
+  static bool start_native_input(JSObject *stream);
+  static bool native_input(JSObject *stream);
+
+  /**
+   * If the rewriter's output is enqueued on its readable side and that is full, returns a promise
+   * that is resolved once the readable side is read from again. Returns nullptr otherwise.
+   */
+  static JSObject *output_backpressure(JSObject *stream);
+
+  /// Run `len` bytes of input through the rewriter.
+  static bool write_input(JSContext *cx, JS::HandleObject stream, const uint8_t *data,
+                          size_t len);
+  static void finalize(JS::GCContext *gcx, JSObject *self);
+  static void trace(JSTracer *trc, JSObject *self);
+};
+
+/**
+ * A set of element handlers, registered once and shared by every HTMLRewritingStream created from
+ * it. Templates are meant to be set up during initialization, so that the builder, parsed
+ * selectors and handlers are part of the snapshot and requests only pay for creating a stream.
+ */
+class HTMLRewritingStreamTemplate
+    : public builtins::TraceableBuiltinImpl<HTMLRewritingStreamTemplate> {
+private:
+  static bool onElement(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool createStream(JSContext *cx, unsigned argc, JS::Value *vp);
+
+public:
+  static constexpr const char *class_name = "HTMLRewritingStreamTemplate";
+  static const int ctor_length = 0;
+  enum Slots {
+    RawBuilder,
+    ElementHandlers,
+    PreallocatedParsingBufferSize,
+    MaxAllowedMemoryUsage,
+    Used,
+    Count
+  };
+  static const JSFunctionSpec static_methods[];
+  static const JSPropertySpec static_properties[];
+  static const JSFunctionSpec methods[];
+  static const JSPropertySpec properties[];
+
+  static bool constructor(JSContext *cx, unsigned argc, JS::Value *vp);
+
   static void finalize(JS::GCContext *gcx, JSObject *self);
   static void trace(JSTracer *trc, JSObject *self);
 };
 } // namespace fastly::html_rewriter
 
-#endif
\ No newline at end of file
+#endif
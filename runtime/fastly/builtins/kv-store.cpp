@@ -1,8 +1,12 @@
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 // TODO: remove these once the warnings are fixed
 #pragma clang diagnostic push
@@ -11,12 +15,15 @@
 #include "js/experimental/TypedData.h"
 #pragma clang diagnostic pop
 
+#include "js/Array.h"
 #include "js/ArrayBuffer.h"
+#include "js/MapAndSet.h"
 #include "js/Stream.h"
 
 #include "../../../StarlingMonkey/builtins/web/base64.h"
 #include "../../../StarlingMonkey/builtins/web/streams/native-stream-source.h"
 #include "../../../StarlingMonkey/builtins/web/url.h"
+#include "../common/lru_cache.h"
 #include "../common/validations.h"
 #include "../host-api/host_api_fastly.h"
 #include "./fastly.h"
@@ -56,12 +63,86 @@ std::optional<char> find_invalid_character_for_kv_store_key(const char *str, siz
   return res;
 }
 
+// Creates an ArrayBuffer that takes ownership of `bytes`.
+JSObject *array_buffer_from_bytes(JSContext *cx, host_api::HostBytes bytes) {
+  JS::RootedObject buffer(
+      cx, JS::NewArrayBufferWithContents(cx, bytes.len, bytes.ptr.get(),
+                                         JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
+  if (!buffer) {
+    JS_ReportOutOfMemory(cx);
+    return nullptr;
+  }
+
+  // `buffer` now owns `bytes`
+  static_cast<void>(bytes.ptr.release());
+  return buffer;
+}
+
+// Gives an entry served from the lookup cache a body stream that yields its bytes in one chunk.
+bool create_cached_body_stream(JSContext *cx, JS::HandleObject self) {
+  JS::RootedObject buffer(
+      cx, &JS::GetReservedSlot(self, static_cast<uint32_t>(KVStoreEntry::Slots::CachedBody))
+               .toObject());
+  JS::RootedObject stream(cx, JS::NewReadableDefaultStreamObject(cx));
+  if (!stream) {
+    return false;
+  }
+
+  size_t len = JS::GetArrayBufferByteLength(buffer);
+  if (len > 0) {
+    JS::RootedObject chunk(cx, JS_NewUint8ArrayWithBuffer(cx, buffer, 0, len));
+    if (!chunk) {
+      return false;
+    }
+    JS::RootedValue chunk_val(cx, JS::ObjectValue(*chunk));
+    if (!JS::ReadableStreamEnqueue(cx, stream, chunk_val)) {
+      return false;
+    }
+  }
+  if (!JS::ReadableStreamClose(cx, stream)) {
+    return false;
+  }
+
+  JS::SetReservedSlot(self, static_cast<uint32_t>(KVStoreEntry::Slots::CachedBody),
+                      JS::UndefinedValue());
+  JS::SetReservedSlot(self, static_cast<uint32_t>(KVStoreEntry::Slots::BodyStream),
+                      JS::ObjectValue(*stream));
+  return true;
+}
+
 } // namespace
 
 template <RequestOrResponse::BodyReadResult result_type>
 bool KVStoreEntry::bodyAll(JSContext *cx, unsigned argc, JS::Value *vp) {
   METHOD_HEADER(0)
-  return RequestOrResponse::bodyAll<result_type, false>(cx, args, self);
+  JS::RootedValue cached_body(cx,
+                              JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::CachedBody)));
+  if (!cached_body.isObject()) {
+    return RequestOrResponse::bodyAll<result_type, false>(cx, args, self);
+  }
+
+  // A value served from the lookup cache is parsed straight from its bytes. The slot is only set
+  // while the body is unused and has no stream.
+  JS::RootedObject result_promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!result_promise) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::RootedObject buffer(cx, &cached_body.toObject());
+  size_t len = JS::GetArrayBufferByteLength(buffer);
+  JS::UniqueChars chars(static_cast<char *>(JS::StealArrayBufferContents(cx, buffer)));
+  if (!chars && JS_IsExceptionPending(cx)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::CachedBody), JS::UndefinedValue());
+  JS::SetReservedSlot(self, static_cast<uint32_t>(RequestOrResponse::Slots::BodyAllPromise),
+                      JS::ObjectValue(*result_promise));
+  if (!RequestOrResponse::mark_body_used(cx, self) ||
+      !RequestOrResponse::parse_body<result_type>(cx, self, std::move(chars), len)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  args.rval().setObject(*result_promise);
+  return true;
 }
 
 bool KVStoreEntry::body_get(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -69,6 +150,10 @@ bool KVStoreEntry::body_get(JSContext *cx, unsigned argc, JS::Value *vp) {
   if (!JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::HasBody)).isBoolean()) {
     JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::HasBody), JS::BooleanValue(false));
   }
+  if (JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::CachedBody)).isObject() &&
+      !create_cached_body_stream(cx, self)) {
+    return false;
+  }
   return RequestOrResponse::body_get(cx, args, self);
 }
 
@@ -151,18 +236,13 @@ JSObject *KVStoreEntry::create(JSContext *cx, host_api::HttpBody body_handle,
   JS::SetReservedSlot(kvStoreEntry, static_cast<uint32_t>(Slots::HasBody), JS::BooleanValue(true));
   JS::SetReservedSlot(kvStoreEntry, static_cast<uint32_t>(Slots::BodyUsed), JS::FalseValue());
   if (metadata) {
-    JS::RootedObject buffer(
-        cx, JS::NewArrayBufferWithContents(cx, metadata.len, metadata.ptr.get(),
-                                           JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
+    auto metadata_len = metadata.len;
+    JS::RootedObject buffer(cx, array_buffer_from_bytes(cx, std::move(metadata)));
     if (!buffer) {
-      JS_ReportOutOfMemory(cx);
       return nullptr;
     }
 
-    // `array_buffer` now owns `metadata`
-    static_cast<void>(metadata.ptr.release());
-
-    JS::RootedObject uint8_array(cx, JS_NewUint8ArrayWithBuffer(cx, buffer, 0, metadata.len));
+    JS::RootedObject uint8_array(cx, JS_NewUint8ArrayWithBuffer(cx, buffer, 0, metadata_len));
 
     JS::SetReservedSlot(kvStoreEntry, static_cast<uint32_t>(Slots::Metadata),
                         JS::ObjectValue(*uint8_array));
@@ -172,6 +252,23 @@ JSObject *KVStoreEntry::create(JSContext *cx, host_api::HttpBody body_handle,
   return kvStoreEntry;
 }
 
+JSObject *KVStoreEntry::create(JSContext *cx, host_api::HostBytes body,
+                               host_api::HostBytes metadata) {
+  JS::RootedObject buffer(cx, array_buffer_from_bytes(cx, std::move(body)));
+  if (!buffer) {
+    return nullptr;
+  }
+
+  // The body handle is never used: the body is read from the bytes, or from a stream over them.
+  JS::RootedObject kvStoreEntry(cx, create(cx, host_api::HttpBody(), std::move(metadata)));
+  if (!kvStoreEntry) {
+    return nullptr;
+  }
+  JS::SetReservedSlot(kvStoreEntry, static_cast<uint32_t>(Slots::CachedBody),
+                      JS::ObjectValue(*buffer));
+  return kvStoreEntry;
+}
+
 namespace {
 
 host_api::KVStore kv_store(JSObject *obj) {
@@ -346,6 +443,335 @@ bool process_pending_kv_store_lookup(JSContext *cx, host_api::KVStorePendingLook
   return true;
 }
 
+constexpr size_t DEFAULT_KV_CACHE_MAX_BYTES = 8 * 1024 * 1024;
+constexpr uint64_t DEFAULT_KV_CACHE_MAX_AGE_NS = 60ull * 1000 * 1000 * 1000;
+
+// A value cached by the opt-in lookup cache, see `KVStore.enableCache`. Entries weigh the size of
+// their key, value and metadata.
+struct KVCacheEntry {
+  host_api::HostBytes body;
+  host_api::HostBytes metadata;
+  uint32_t generation;
+  uint64_t fresh_until;
+
+  KVCacheEntry(host_api::HostBytes body, host_api::HostBytes metadata, uint32_t generation,
+               uint64_t fresh_until)
+      : body(std::move(body)), metadata(std::move(metadata)), generation(generation),
+        fresh_until(fresh_until) {}
+};
+
+// The lookup cache is shared by every request handled by a reusable sandbox, so it lives here
+// rather than in per-request builtin state.
+struct KVCacheState {
+  bool enabled = false;
+  uint64_t max_age_ns = 0;
+  common::LruCache<KVCacheEntry> entries;
+  std::vector<std::string> store_names;
+  // Bumped by every `put` and `delete` on the store with the same index in `store_names`, so that
+  // lookups started before a write can tell that their value may be out of date.
+  std::vector<uint64_t> write_epochs;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t revalidations = 0;
+};
+
+KVCacheState kv_cache;
+
+uint32_t kv_cache_store_id(std::string_view store_name) {
+  auto &names = kv_cache.store_names;
+  auto found = std::find(names.begin(), names.end(), store_name);
+  if (found != names.end()) {
+    return found - names.begin();
+  }
+  names.emplace_back(store_name);
+  kv_cache.write_epochs.push_back(0);
+  return names.size() - 1;
+}
+
+uint32_t kv_cache_store_id(JSObject *store) {
+  return JS::GetReservedSlot(store, static_cast<uint32_t>(KVStore::Slots::CacheStoreId)).toInt32();
+}
+
+std::string kv_cache_key(JSObject *store, std::string_view key) {
+  uint32_t store_id = kv_cache_store_id(store);
+  std::string cache_key(reinterpret_cast<const char *>(&store_id), sizeof(store_id));
+  cache_key.append(key);
+  return cache_key;
+}
+
+// Drops the cached value for a key that's about to be written, and bumps the store's write epoch
+// so that lookups already in flight don't cache the value from before the write.
+void kv_cache_invalidate(JSObject *store, std::string_view key) {
+  kv_cache.write_epochs[kv_cache_store_id(store)]++;
+  if (kv_cache.enabled) {
+    kv_cache.entries.erase(kv_cache_key(store, key));
+  }
+}
+
+void kv_cache_insert(std::string cache_key, host_api::HostBytes body,
+                     host_api::HostBytes metadata, uint32_t generation) {
+  auto size = cache_key.size() + body.len + metadata.len;
+  auto fresh_until = host_api::MonotonicClock::now() + kv_cache.max_age_ns;
+  kv_cache.entries.insert_weighted(std::move(cache_key), size, std::move(body),
+                                   std::move(metadata), generation, fresh_until);
+}
+
+host_api::HostBytes copy_host_bytes(const host_api::HostBytes &bytes) {
+  if (!bytes) {
+    return host_api::HostBytes{};
+  }
+  auto copy = host_api::HostBytes::with_capacity(bytes.len);
+  std::memcpy(copy.begin(), bytes.begin(), bytes.len);
+  return copy;
+}
+
+// Creates a KVStoreEntry that reads a copy of `body` and `metadata` from memory, without hostcalls.
+JSObject *create_entry_from_bytes(JSContext *cx, const host_api::HostBytes &body,
+                                  const host_api::HostBytes &metadata) {
+  return KVStoreEntry::create(cx, copy_host_bytes(body), copy_host_bytes(metadata));
+}
+
+// Waits on a lookup made while the lookup cache is enabled, and stores its result in the cache.
+//
+// If the cache already holds the same generation of the value, only its freshness is renewed and
+// the looked up body is handed out as is. Otherwise the body is read into the cache, as long as it
+// fits, and the entry reads a copy of it from memory.
+//
+// If the store was written to after the lookup started, the result is handed out without touching
+// the cache, because it may predate the write.
+class KVCachedLookupTask final : public api::AsyncTask {
+  std::string cache_key_;
+  uint32_t store_id_;
+  uint64_t write_epoch_;
+  Heap<JSObject *> promise_;
+
+public:
+  explicit KVCachedLookupTask(host_api::KVStorePendingLookup::Handle handle, std::string cache_key,
+                              uint32_t store_id, JS::HandleObject promise)
+      : cache_key_(std::move(cache_key)), store_id_(store_id),
+        write_epoch_(kv_cache.write_epochs[store_id]), promise_(promise) {
+    handle_ = static_cast<int32_t>(handle);
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    JSContext *cx = engine->cx();
+    JS::RootedObject promise(cx, promise_);
+
+    host_api::KVStorePendingLookup pending_lookup(handle_);
+    auto res = pending_lookup.wait();
+    if (auto *err = res.to_err()) {
+      HANDLE_KV_ERROR(cx, *err, JSMSG_KV_STORE_LOOKUP_ERROR);
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+
+    bool update_cache = kv_cache.enabled && kv_cache.write_epochs[store_id_] == write_epoch_;
+    if (!res.unwrap().has_value()) {
+      if (update_cache) {
+        kv_cache.entries.erase(cache_key_);
+      }
+      return JS::ResolvePromise(cx, promise, JS::NullHandleValue);
+    }
+
+    host_api::HttpBody body = std::get<0>(res.unwrap().value());
+    host_api::HostBytes metadata = std::move(std::get<1>(res.unwrap().value()));
+    uint32_t generation = std::get<2>(res.unwrap().value());
+
+    JS::RootedObject entry(cx);
+    auto *cached = update_cache ? kv_cache.entries.find(cache_key_) : nullptr;
+    if (cached && cached->generation == generation) {
+      cached->fresh_until = host_api::MonotonicClock::now() + kv_cache.max_age_ns;
+      kv_cache.revalidations++;
+      entry = KVStoreEntry::create(cx, body, std::move(metadata));
+    } else {
+      auto length_res = body.known_length();
+      if (auto *err = length_res.to_err()) {
+        HANDLE_ERROR(cx, *err);
+        return RejectPromiseWithPendingError(cx, promise);
+      }
+      auto length = length_res.unwrap();
+      if (update_cache && length.has_value() &&
+          cache_key_.size() + length.value() + metadata.len <= kv_cache.entries.max_weight()) {
+        auto read_res = body.read_all();
+        if (auto *err = read_res.to_err()) {
+          HANDLE_ERROR(cx, *err);
+          return RejectPromiseWithPendingError(cx, promise);
+        }
+        auto bytes = std::move(read_res.unwrap());
+        entry = create_entry_from_bytes(cx, bytes, metadata);
+        kv_cache_insert(std::move(cache_key_), std::move(bytes), std::move(metadata), generation);
+      } else {
+        // Values that are too large, or whose length isn't known up front, aren't cached.
+        if (update_cache) {
+          kv_cache.entries.erase(cache_key_);
+        }
+        entry = KVStoreEntry::create(cx, body, std::move(metadata));
+      }
+    }
+    if (!entry) {
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+
+    JS::RootedValue result(cx, JS::ObjectValue(*entry));
+    return JS::ResolvePromise(cx, promise, result);
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override { return false; }
+
+  void trace(JSTracer *trc) override { TraceEdge(trc, &promise_, "KVStore cached lookup promise"); }
+};
+
+// The lookups for a single `KVStore.prototype.getMany` call, shared by the tasks waiting on them.
+struct GetManyState {
+  host_api::KVStore store;
+  // How many lookups may be in flight at once. All of them are started up front by default.
+  size_t concurrency = SIZE_MAX;
+  // Keys that haven't been looked up yet, last one first.
+  std::vector<std::string> pending_keys;
+  // Each lookup that has been started, with its key, oldest first.
+  std::vector<std::pair<std::string, host_api::KVStorePendingLookup>> in_flight;
+};
+
+// Start lookups for pending keys until `concurrency` of them are in flight.
+bool start_get_many_lookups(JSContext *cx, GetManyState &state) {
+  while (state.in_flight.size() < state.concurrency && !state.pending_keys.empty()) {
+    auto key = std::move(state.pending_keys.back());
+    state.pending_keys.pop_back();
+    auto res = state.store.lookup(key);
+    if (auto *err = res.to_err()) {
+      HANDLE_ERROR(cx, *err);
+      return false;
+    }
+    state.in_flight.emplace_back(std::move(key), host_api::KVStorePendingLookup(res.unwrap()));
+  }
+  return true;
+}
+
+using KVLookupResult = decltype(std::declval<host_api::KVStorePendingLookup &>().wait());
+
+// Store the result of a single `getMany` lookup into `entries`.
+bool store_get_many_result(JSContext *cx, const std::string &key_chars, KVLookupResult &res,
+                           JS::HandleObject entries) {
+  if (auto *err = res.to_err()) {
+    HANDLE_KV_ERROR(cx, *err, JSMSG_KV_STORE_LOOKUP_ERROR);
+    return false;
+  }
+  JS::RootedValue value(cx);
+  if (res.unwrap().has_value()) {
+    host_api::HttpBody body = std::get<0>(res.unwrap().value());
+    host_api::HostBytes metadata = std::move(std::get<1>(res.unwrap().value()));
+    JSObject *entry = KVStoreEntry::create(cx, body, std::move(metadata));
+    if (!entry) {
+      return false;
+    }
+    value.setObject(*entry);
+  }
+
+  JSString *key_str = JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(key_chars.data(), key_chars.size()));
+  if (!key_str) {
+    return false;
+  }
+  JS::RootedValue key(cx, JS::StringValue(key_str));
+  return JS::MapSet(cx, entries, key, value);
+}
+
+// Store the results of the oldest lookup in flight, which must be ready, and of the lookups after
+// it that are ready as well, into `entries`. Collection stops at the first lookup that isn't ready,
+// so that each lookup is only checked for readiness about once. Every lookup that was waited on is
+// removed from `in_flight`, even if storing its result failed.
+bool collect_get_many_lookups(JSContext *cx, GetManyState &state, JS::HandleObject entries) {
+  size_t collected = 0;
+  bool ok = true;
+  for (auto &[key_chars, lookup] : state.in_flight) {
+    if (collected > 0) {
+      auto ready = lookup.is_ready();
+      if (auto *err = ready.to_err()) {
+        HANDLE_ERROR(cx, *err);
+        ok = false;
+        break;
+      }
+      if (!ready.unwrap()) {
+        break;
+      }
+    }
+
+    auto res = lookup.wait();
+    collected++;
+    if (!store_get_many_result(cx, key_chars, res, entries)) {
+      ok = false;
+      break;
+    }
+  }
+
+  state.in_flight.erase(state.in_flight.begin(), state.in_flight.begin() + collected);
+  return ok;
+}
+
+// Waits for a lookup whose result is no longer needed, releasing its handle and closing the body
+// of any value it found.
+bool discard_kv_store_lookup(JSContext *cx, host_api::KVStorePendingLookup::Handle handle,
+                             JS::HandleObject context, JS::HandleValue extra) {
+  auto res = host_api::KVStorePendingLookup(handle).wait();
+  if (!res.is_err() && res.unwrap().has_value()) {
+    std::ignore = std::get<0>(res.unwrap().value()).close();
+  }
+  return true;
+}
+
+// Gives up on a failed `getMany` call: keys that haven't been looked up yet are dropped, and the
+// lookups still in flight are discarded as they complete, without blocking on them.
+void abandon_get_many_lookups(GetManyState &state, JS::HandleObject promise) {
+  state.pending_keys.clear();
+  for (auto &[key_chars, lookup] : state.in_flight) {
+    ENGINE->queue_async_task(new FastlyAsyncTask(lookup.async_handle(), promise,
+                                                 JS::UndefinedHandleValue,
+                                                 discard_kv_store_lookup));
+  }
+  state.in_flight.clear();
+}
+
+// Waits on the oldest lookup in flight for a `getMany` call. When that completes, the task
+// collects every result that is ready, starts more lookups, and queues a single new task for
+// whatever is still outstanding, so that the whole batch settles one promise.
+class KVGetManyTask final : public api::AsyncTask {
+  std::shared_ptr<GetManyState> state_;
+  Heap<JSObject *> entries_;
+  Heap<JSObject *> promise_;
+
+public:
+  explicit KVGetManyTask(std::shared_ptr<GetManyState> state, JS::HandleObject entries,
+                         JS::HandleObject promise)
+      : state_(std::move(state)), entries_(entries), promise_(promise) {
+    handle_ = static_cast<int32_t>(state_->in_flight.front().second.async_handle());
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    JSContext *cx = engine->cx();
+    JS::RootedObject entries(cx, entries_);
+    JS::RootedObject promise(cx, promise_);
+
+    if (!collect_get_many_lookups(cx, *state_, entries) ||
+        !start_get_many_lookups(cx, *state_)) {
+      abandon_get_many_lookups(*state_, promise);
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+
+    if (state_->in_flight.empty()) {
+      JS::RootedValue entries_val(cx, JS::ObjectValue(*entries));
+      return JS::ResolvePromise(cx, promise, entries_val);
+    }
+
+    engine->queue_async_task(new KVGetManyTask(state_, entries, promise));
+    return true;
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override { return false; }
+
+  void trace(JSTracer *trc) override {
+    TraceEdge(trc, &entries_, "KVStore getMany entries");
+    TraceEdge(trc, &promise_, "KVStore getMany promise");
+  }
+};
+
 } // namespace
 
 bool KVStore::delete_(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -368,6 +794,8 @@ bool KVStore::delete_(JSContext *cx, unsigned argc, JS::Value *vp) {
     return ReturnPromiseRejectedWithPendingError(cx, args);
   }
 
+  kv_cache_invalidate(self, key_chars);
+
   auto res = kv_store(self).delete_(key_chars);
 
   if (auto *err = res.to_err()) {
@@ -404,6 +832,26 @@ bool KVStore::get(JSContext *cx, unsigned argc, JS::Value *vp) {
     return ReturnPromiseRejectedWithPendingError(cx, args);
   }
 
+  std::string cache_key;
+  if (kv_cache.enabled) {
+    cache_key = kv_cache_key(self, key_chars);
+    auto *cached = kv_cache.entries.find(cache_key);
+    if (cached && host_api::MonotonicClock::now() < cached->fresh_until) {
+      kv_cache.hits++;
+      JS::RootedObject entry(cx, create_entry_from_bytes(cx, cached->body, cached->metadata));
+      if (!entry) {
+        return ReturnPromiseRejectedWithPendingError(cx, args);
+      }
+      JS::RootedValue entry_val(cx, JS::ObjectValue(*entry));
+      if (!JS::ResolvePromise(cx, result_promise, entry_val)) {
+        return false;
+      }
+      args.rval().setObject(*result_promise);
+      return true;
+    }
+    kv_cache.misses++;
+  }
+
   auto res = kv_store(self).lookup(key_chars);
 
   if (auto *err = res.to_err()) {
@@ -412,10 +860,125 @@ bool KVStore::get(JSContext *cx, unsigned argc, JS::Value *vp) {
   }
   auto handle = res.unwrap();
 
-  JS::RootedValue result_promise_val(cx, JS::ObjectValue(*result_promise));
-  auto task =
-      new FastlyAsyncTask(handle, self, result_promise_val, process_pending_kv_store_lookup);
-  ENGINE->queue_async_task(task);
+  if (kv_cache.enabled) {
+    ENGINE->queue_async_task(new KVCachedLookupTask(handle, std::move(cache_key),
+                                                    kv_cache_store_id(self), result_promise));
+  } else {
+    JS::RootedValue result_promise_val(cx, JS::ObjectValue(*result_promise));
+    auto task =
+        new FastlyAsyncTask(handle, self, result_promise_val, process_pending_kv_store_lookup);
+    ENGINE->queue_async_task(task);
+  }
+
+  args.rval().setObject(*result_promise);
+  return true;
+}
+
+bool KVStore::getMany(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(1)
+
+  JS::RootedObject result_promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!result_promise) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  bool is_array = false;
+  if (!JS::IsArrayObject(cx, args.get(0), &is_array)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  if (!is_array) {
+    api::throw_error(cx, api::Errors::TypeError, "KVStore.getMany", "keys", "be an array");
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::RootedObject keys(cx, &args.get(0).toObject());
+
+  auto state = std::make_shared<GetManyState>();
+  state->store = kv_store(self);
+
+  JS::HandleValue options_val = args.get(1);
+  if (!options_val.isNullOrUndefined()) {
+    if (!options_val.isObject()) {
+      api::throw_error(cx, api::Errors::TypeError, "KVStore.getMany", "options", "be an object");
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    JS::RootedObject options(cx, &options_val.toObject());
+    JS::RootedValue concurrency_val(cx);
+    if (!JS_GetProperty(cx, options, "concurrency", &concurrency_val)) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    if (!concurrency_val.isNullOrUndefined()) {
+      double concurrency = concurrency_val.isNumber() ? concurrency_val.toNumber() : 0;
+      if (!(concurrency >= 1) || std::floor(concurrency) != concurrency) {
+        api::throw_error(cx, api::Errors::TypeError, "KVStore.getMany", "concurrency",
+                         "be a positive integer");
+        return ReturnPromiseRejectedWithPendingError(cx, args);
+      }
+      state->concurrency = concurrency > SIZE_MAX ? SIZE_MAX : static_cast<size_t>(concurrency);
+    }
+  }
+
+  uint32_t length = 0;
+  if (!JS::GetArrayLength(cx, keys, &length)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // Every key gets an entry up front, so that the result is in the order of `keys` regardless of
+  // the order in which the lookups complete. Repeated keys are only looked up once.
+  JS::RootedObject entries(cx, JS::NewMapObject(cx));
+  if (!entries) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::RootedValue key(cx);
+  JS::RootedString key_str(cx);
+  std::vector<std::string> key_strings;
+  key_strings.reserve(length);
+  for (uint32_t i = 0; i < length; i++) {
+    if (!JS_GetElement(cx, keys, i, &key)) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    // Convert the key into a String following https://tc39.es/ecma262/#sec-tostring
+    key_str = JS::ToString(cx, key);
+    if (!key_str) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    key.setString(key_str);
+    auto key_chars = core::encode(cx, key);
+    if (!key_chars) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    if (!parse_and_validate_key(cx, key_chars.begin(), key_chars.len)) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    bool seen = false;
+    if (!JS::MapHas(cx, entries, key, &seen)) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    if (seen) {
+      continue;
+    }
+    if (!JS::MapSet(cx, entries, key, JS::NullHandleValue)) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    key_strings.emplace_back(key_chars.begin(), key_chars.len);
+  }
+
+  if (key_strings.empty()) {
+    JS::RootedValue entries_val(cx, JS::ObjectValue(*entries));
+    if (!JS::ResolvePromise(cx, result_promise, entries_val)) {
+      return false;
+    }
+    args.rval().setObject(*result_promise);
+    return true;
+  }
+
+  state->pending_keys.assign(std::make_move_iterator(key_strings.rbegin()),
+                             std::make_move_iterator(key_strings.rend()));
+  if (!start_get_many_lookups(cx, *state)) {
+    abandon_get_many_lookups(*state, result_promise);
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  ENGINE->queue_async_task(new KVGetManyTask(state, entries, result_promise));
 
   args.rval().setObject(*result_promise);
   return true;
@@ -441,6 +1004,8 @@ bool KVStore::put(JSContext *cx, unsigned argc, JS::Value *vp) {
     return false;
   }
 
+  kv_cache_invalidate(self, key_chars);
+
   JS::HandleValue body_val = args.get(1);
 
   JS::RootedValue metadata_val(cx);
@@ -782,7 +1347,336 @@ bool KVStore::list(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
+namespace {
+
+// Start fetching the page of keys after `cursor` for a `listAll` iterator. The promise for the
+// page is stored in the iterator's NextPage slot.
+bool fetch_list_page(JSContext *cx, JS::HandleObject iter, std::optional<std::string_view> cursor) {
+  using Slots = KVStoreListIterator::Slots;
+  host_api::KVStore store(
+      JS::GetReservedSlot(iter, static_cast<uint32_t>(Slots::KVStore)).toInt32());
+
+  std::optional<std::string_view> prefix = std::nullopt;
+  host_api::HostString prefix_str;
+  JS::RootedValue prefix_val(cx, JS::GetReservedSlot(iter, static_cast<uint32_t>(Slots::Prefix)));
+  if (prefix_val.isString()) {
+    prefix_str = core::encode(cx, prefix_val);
+    if (!prefix_str) {
+      return false;
+    }
+    prefix = prefix_str;
+  }
+
+  std::optional<uint32_t> limit = std::nullopt;
+  JS::Value page_size = JS::GetReservedSlot(iter, static_cast<uint32_t>(Slots::PageSize));
+  if (page_size.isNumber()) {
+    limit.emplace(page_size.toNumber());
+  }
+  bool no_sync = JS::GetReservedSlot(iter, static_cast<uint32_t>(Slots::NoSync)).toBoolean();
+
+  auto res = store.list(cursor, limit, prefix, no_sync);
+  if (auto *err = res.to_err()) {
+    HANDLE_ERROR(cx, *err);
+    return false;
+  }
+
+  JS::RootedObject page_promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!page_promise) {
+    return false;
+  }
+  JS::RootedValue page_promise_val(cx, JS::ObjectValue(*page_promise));
+  ENGINE->queue_async_task(
+      new FastlyAsyncTask(res.unwrap(), iter, page_promise_val, process_pending_kv_store_list));
+  JS::SetReservedSlot(iter, static_cast<uint32_t>(Slots::NextPage), page_promise_val);
+  return true;
+}
+
+JSObject *iterator_result(JSContext *cx, JS::HandleValue value, bool done) {
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return nullptr;
+  }
+  JS::RootedValue done_val(cx, JS::BooleanValue(done));
+  if (!JS_DefineProperty(cx, result, "value", value, JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, result, "done", done_val, JSPROP_ENUMERATE)) {
+    return nullptr;
+  }
+  JS::RootedValue result_val(cx, JS::ObjectValue(*result));
+  return JS::CallOriginalPromiseResolve(cx, result_val);
+}
+
+bool list_iterator_page_then(JSContext *cx, JS::HandleObject iter, JS::HandleValue extra,
+                             JS::CallArgs args);
+
+// Returns a promise for the iterator's next result: the next key of the current page if there is
+// one, otherwise the first key of the next page once it has arrived.
+JSObject *list_iterator_step(JSContext *cx, JS::HandleObject iter) {
+  using Slots = KVStoreListIterator::Slots;
+  JS::RootedValue page_val(cx, JS::GetReservedSlot(iter, static_cast<uint32_t>(Slots::Page)));
+  if (page_val.isObject()) {
+    JS::RootedObject page(cx, &page_val.toObject());
+    uint32_t length = 0;
+    if (!JS::GetArrayLength(cx, page, &length)) {
+      return nullptr;
+    }
+    uint32_t index = JS::GetReservedSlot(iter, static_cast<uint32_t>(Slots::Index)).toInt32();
+    if (index < length) {
+      JS::RootedValue key(cx);
+      if (!JS_GetElement(cx, page, index, &key)) {
+        return nullptr;
+      }
+      JS::SetReservedSlot(iter, static_cast<uint32_t>(Slots::Index), JS::Int32Value(index + 1));
+      return iterator_result(cx, key, false);
+    }
+  }
+
+  JS::RootedValue next_page(cx, JS::GetReservedSlot(iter, static_cast<uint32_t>(Slots::NextPage)));
+  if (next_page.isNull()) {
+    return iterator_result(cx, JS::UndefinedHandleValue, true);
+  }
+  JS::RootedObject next_page_obj(cx, &next_page.toObject());
+  JS::RootedObject then_handler(cx, create_internal_method<list_iterator_page_then>(cx, iter));
+  if (!then_handler) {
+    return nullptr;
+  }
+  return JS::CallOriginalPromiseThen(cx, next_page_obj, then_handler, nullptr);
+}
+
+// Makes a newly arrived page the current one, and immediately starts fetching the page after it.
+bool list_iterator_page_then(JSContext *cx, JS::HandleObject iter, JS::HandleValue extra,
+                             JS::CallArgs args) {
+  using Slots = KVStoreListIterator::Slots;
+  JS::RootedValue result(cx, args.get(0));
+  if (!result.isObject()) {
+    JS_ReportErrorLatin1(cx, "Bad data.");
+    return false;
+  }
+  JS::RootedObject result_obj(cx, &result.toObject());
+  JS::RootedValue list(cx);
+  JS::RootedValue cursor(cx);
+  if (!JS_GetProperty(cx, result_obj, "list", &list) ||
+      !JS_GetProperty(cx, result_obj, "cursor", &cursor)) {
+    return false;
+  }
+  bool is_array = false;
+  if (!JS::IsArrayObject(cx, list, &is_array)) {
+    return false;
+  }
+  if (!is_array) {
+    JS_ReportErrorLatin1(cx, "Bad data.");
+    return false;
+  }
+  JS::SetReservedSlot(iter, static_cast<uint32_t>(Slots::Page), list);
+  JS::SetReservedSlot(iter, static_cast<uint32_t>(Slots::Index), JS::Int32Value(0));
+
+  if (cursor.isString() && JS_GetStringLength(cursor.toString()) > 0) {
+    auto cursor_str = core::encode(cx, cursor);
+    if (!cursor_str || !fetch_list_page(cx, iter, std::string_view(cursor_str))) {
+      return false;
+    }
+  } else {
+    JS::SetReservedSlot(iter, static_cast<uint32_t>(Slots::NextPage), JS::NullValue());
+  }
+
+  JS::RootedObject step(cx, list_iterator_step(cx, iter));
+  if (!step) {
+    return false;
+  }
+  args.rval().setObject(*step);
+  return true;
+}
+
+bool list_iterator_after_pending(JSContext *cx, JS::HandleObject iter, JS::HandleValue extra,
+                                 JS::CallArgs args) {
+  JS::RootedObject step(cx, list_iterator_step(cx, iter));
+  if (!step) {
+    return false;
+  }
+  args.rval().setObject(*step);
+  return true;
+}
+
+} // namespace
+
+bool KVStoreListIterator::next(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0)
+
+  // Calls made before the previous call's result has settled wait for it first, so that they don't
+  // race to consume the same page.
+  JS::RootedObject result(cx);
+  JS::RootedValue pending(cx, JS::GetReservedSlot(self, static_cast<uint32_t>(Slots::PendingNext)));
+  if (pending.isObject() &&
+      JS::GetPromiseState(&pending.toObject()) == JS::PromiseState::Pending) {
+    JS::RootedObject pending_obj(cx, &pending.toObject());
+    JS::RootedObject handler(cx, create_internal_method<list_iterator_after_pending>(cx, self));
+    if (!handler) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    result = JS::CallOriginalPromiseThen(cx, pending_obj, handler, handler);
+  } else {
+    result = list_iterator_step(cx, self);
+  }
+  if (!result) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  JS::SetReservedSlot(self, static_cast<uint32_t>(Slots::PendingNext), JS::ObjectValue(*result));
+  args.rval().setObject(*result);
+  return true;
+}
+
+bool KVStoreListIterator::async_iterator(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0)
+  args.rval().setObject(*self);
+  return true;
+}
+
+const JSFunctionSpec KVStoreListIterator::static_methods[] = {
+    JS_FS_END,
+};
+
+const JSPropertySpec KVStoreListIterator::static_properties[] = {
+    JS_PS_END,
+};
+
+const JSFunctionSpec KVStoreListIterator::methods[] = {
+    JS_FN("next", next, 0, JSPROP_ENUMERATE),
+    JS_SYM_FN(asyncIterator, async_iterator, 0, 0),
+    JS_FS_END,
+};
+
+const JSPropertySpec KVStoreListIterator::properties[] = {
+    JS_PS_END,
+};
+
+bool KVStore::listAll(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0)
+
+  JS::RootedValue prefix_val(cx);
+  JS::RootedValue page_size_val(cx);
+  bool no_sync = false;
+  JS::HandleValue options_val = args.get(0);
+  if (!options_val.isUndefined()) {
+    if (!options_val.isObject()) {
+      api::throw_error(cx, api::Errors::TypeError, "KVStore.listAll", "options", "be an object");
+      return false;
+    }
+    JS::RootedObject options(cx, &options_val.toObject());
+
+    if (!JS_GetProperty(cx, options, "prefix", &prefix_val)) {
+      return false;
+    }
+    if (!prefix_val.isNullOrUndefined() && !prefix_val.isString()) {
+      api::throw_error(cx, api::Errors::TypeError, "KVStore.listAll", "prefix", "be a string");
+      return false;
+    }
+
+    if (!JS_GetProperty(cx, options, "pageSize", &page_size_val)) {
+      return false;
+    }
+    if (!page_size_val.isNullOrUndefined()) {
+      double page_size = page_size_val.isNumber() ? page_size_val.toNumber() : 0;
+      if (!(page_size >= 1) || page_size > UINT32_MAX || std::floor(page_size) != page_size) {
+        api::throw_error(cx, api::Errors::TypeError, "KVStore.listAll", "pageSize",
+                         "be a positive integer");
+        return false;
+      }
+    }
+
+    JS::RootedValue no_sync_val(cx);
+    if (!JS_GetProperty(cx, options, "noSync", &no_sync_val)) {
+      return false;
+    }
+    if (!no_sync_val.isNullOrUndefined()) {
+      if (!no_sync_val.isBoolean()) {
+        api::throw_error(cx, api::Errors::TypeError, "KVStore.listAll", "noSync", "be a boolean");
+        return false;
+      }
+      no_sync = no_sync_val.toBoolean();
+    }
+  }
+
+  JS::RootedObject iter(cx, JS_NewObjectWithGivenProto(cx, &KVStoreListIterator::class_,
+                                                       KVStoreListIterator::proto_obj));
+  if (!iter) {
+    return false;
+  }
+  using IteratorSlots = KVStoreListIterator::Slots;
+  JS::SetReservedSlot(iter, static_cast<uint32_t>(IteratorSlots::KVStore),
+                      JS::Int32Value(kv_store(self).handle));
+  JS::SetReservedSlot(iter, static_cast<uint32_t>(IteratorSlots::Prefix),
+                      prefix_val.isString() ? prefix_val.get() : JS::UndefinedValue());
+  JS::SetReservedSlot(iter, static_cast<uint32_t>(IteratorSlots::PageSize),
+                      page_size_val.isNumber() ? page_size_val.get() : JS::UndefinedValue());
+  JS::SetReservedSlot(iter, static_cast<uint32_t>(IteratorSlots::NoSync),
+                      JS::BooleanValue(no_sync));
+  JS::SetReservedSlot(iter, static_cast<uint32_t>(IteratorSlots::Index), JS::Int32Value(0));
+
+  // The first page is requested right away, before the iterator is first used.
+  if (!fetch_list_page(cx, iter, std::nullopt)) {
+    return false;
+  }
+
+  args.rval().setObject(*iter);
+  return true;
+}
+
+bool KVStore::enableCache(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  size_t max_bytes = DEFAULT_KV_CACHE_MAX_BYTES;
+  uint64_t max_age_ns = DEFAULT_KV_CACHE_MAX_AGE_NS;
+
+  JS::RootedObject options(cx);
+  if (!common::cache_options(cx, args.get(0), "KVStore.enableCache", &options) ||
+      !common::cache_limit_option(cx, options, "KVStore.enableCache", "maxBytes", &max_bytes) ||
+      !common::cache_age_option(cx, options, "KVStore.enableCache", "maxAge", &max_age_ns)) {
+    return false;
+  }
+
+  kv_cache.entries.reset(max_bytes);
+  kv_cache.enabled = true;
+  kv_cache.max_age_ns = max_age_ns;
+  args.rval().setUndefined();
+  return true;
+}
+
+bool KVStore::disableCache(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  kv_cache.entries.clear();
+  kv_cache.enabled = false;
+  args.rval().setUndefined();
+  return true;
+}
+
+bool KVStore::cacheStats(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+  std::pair<const char *, double> stats[] = {
+      {"hits", static_cast<double>(kv_cache.hits)},
+      {"misses", static_cast<double>(kv_cache.misses)},
+      {"evictions", static_cast<double>(kv_cache.entries.evictions())},
+      {"revalidations", static_cast<double>(kv_cache.revalidations)},
+      {"entries", static_cast<double>(kv_cache.entries.size())},
+      {"bytes", static_cast<double>(kv_cache.entries.weight())},
+  };
+  JS::RootedValue val(cx);
+  for (auto [name, value] : stats) {
+    val.setNumber(value);
+    if (!JS_DefineProperty(cx, result, name, val, JSPROP_ENUMERATE)) {
+      return false;
+    }
+  }
+  args.rval().setObject(*result);
+  return true;
+}
+
 const JSFunctionSpec KVStore::static_methods[] = {
+    JS_FN("enableCache", enableCache, 0, JSPROP_ENUMERATE),
+    JS_FN("disableCache", disableCache, 0, JSPROP_ENUMERATE),
+    JS_FN("cacheStats", cacheStats, 0, JSPROP_ENUMERATE),
     JS_FS_END,
 };
 
@@ -793,8 +1687,10 @@ const JSPropertySpec KVStore::static_properties[] = {
 const JSFunctionSpec KVStore::methods[] = {
     JS_FN("delete", delete_, 1, JSPROP_ENUMERATE),
     JS_FN("get", get, 1, JSPROP_ENUMERATE),
+    JS_FN("getMany", getMany, 1, JSPROP_ENUMERATE),
     JS_FN("put", put, 1, JSPROP_ENUMERATE),
     JS_FN("list", list, 1, JSPROP_ENUMERATE),
+    JS_FN("listAll", listAll, 0, JSPROP_ENUMERATE),
     JS_FS_END,
 };
 
@@ -854,6 +1750,8 @@ bool KVStore::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
   }
   JS::SetReservedSlot(kv_store, static_cast<uint32_t>(Slots::KVStore),
                       JS::Int32Value(res.unwrap().handle));
+  JS::SetReservedSlot(kv_store, static_cast<uint32_t>(Slots::CacheStoreId),
+                      JS::Int32Value(kv_cache_store_id(name)));
   args.rval().setObject(*kv_store);
   return true;
 }
@@ -866,6 +1764,9 @@ bool install(api::Engine *engine) {
   if (!KVStoreEntry::init_class_impl(engine->cx(), engine->global())) {
     return false;
   }
+  if (!KVStoreListIterator::init_class_impl(engine->cx(), engine->global())) {
+    return false;
+  }
   RootedValue kv_store_val(engine->cx());
   if (!JS_GetProperty(engine->cx(), engine->global(), "KVStore", &kv_store_val)) {
     return false;
@@ -33,6 +33,9 @@ public:
     Backend = static_cast<int>(fetch::RequestOrResponse::Slots::Backend),
     Method = static_cast<int>(fetch::RequestOrResponse::Slots::Count),
     Metadata,
+    // For a value served from the lookup cache, an ArrayBuffer holding its bytes, until the body is
+    // read or its stream is created.
+    CachedBody,
     Count,
   };
   static const JSFunctionSpec static_methods[];
@@ -46,18 +49,57 @@ public:
   static bool constructor(JSContext *cx, unsigned argc, JS::Value *vp);
   static JSObject *create(JSContext *cx, host_api::HttpBody body_handle,
                           host_api::HostBytes metadata);
+  /// Creates an entry whose body is read from `body` in memory rather than from a host body.
+  static JSObject *create(JSContext *cx, host_api::HostBytes body, host_api::HostBytes metadata);
+};
+
+/// The async iterator returned by `KVStore.prototype.listAll`, which yields every key in the store
+/// one page at a time, fetching the next page while the current one is being consumed.
+class KVStoreListIterator final : public builtins::BuiltinNoConstructor<KVStoreListIterator> {
+  static bool next(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool async_iterator(JSContext *cx, unsigned argc, JS::Value *vp);
+
+public:
+  static constexpr const char *class_name = "KVStoreListIterator";
+  static const int ctor_length = 0;
+
+  enum class Slots {
+    KVStore,
+    Prefix,
+    PageSize,
+    NoSync,
+    // The keys of the current page, and the index of the next one to yield.
+    Page,
+    Index,
+    // The promise for the next page, or null once the last page has been fetched.
+    NextPage,
+    // The promise returned by the last call to `next`.
+    PendingNext,
+    Count,
+  };
+  static const JSFunctionSpec static_methods[];
+  static const JSPropertySpec static_properties[];
+  static const JSFunctionSpec methods[];
+  static const JSPropertySpec properties[];
 };
 
 class KVStore final : public builtins::BuiltinImpl<KVStore> {
   static bool delete_(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool getMany(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool put(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool list(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool listAll(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool enableCache(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool disableCache(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool cacheStats(JSContext *cx, unsigned argc, JS::Value *vp);
 
 public:
   static constexpr const char *class_name = "KVStore";
   enum class Slots {
     KVStore,
+    // Identifies the store by name in the opt-in lookup cache, see `KVStore.enableCache`.
+    CacheStoreId,
     Count,
   };
   static const JSFunctionSpec static_methods[];
@@ -1,6 +1,20 @@
 #include "logger.h"
 #include "../../../StarlingMonkey/runtime/encode.h"
+#include "../common/utf16_to_utf8.h"
 #include "../host-api/host_api_fastly.h"
+#include "js/JSON.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Buffered output is written out once this much has accumulated, as well as whenever the event
+// loop goes idle and at the end of each request.
+constexpr size_t OUTPUT_BUFFER_FLUSH_BYTES = 8 * 1024;
+
+} // namespace
 
 namespace builtins::web::console {
 
@@ -22,6 +36,29 @@ public:
 
 bool write_stderr = false;
 bool write_prefix = false;
+bool write_buffered = false;
+
+// Output is only held back while a request is being handled. Anything written during
+// initialization would otherwise be captured in the snapshot, and be written by every instance.
+bool in_request = false;
+
+// Console lines waiting to be written while `write_buffered` is set.
+std::string stdout_buffer;
+std::string stderr_buffer;
+
+void flush_output(FILE *output, std::string &buffer) {
+  if (buffer.empty()) {
+    return;
+  }
+  fwrite(buffer.data(), 1, buffer.size(), output);
+  fflush(output);
+  buffer.clear();
+}
+
+void flush_console_output() {
+  flush_output(stdout, stdout_buffer);
+  flush_output(stderr, stderr_buffer);
+}
 
 void builtin_impl_console_log(Console::LogType log_ty, const char *msg) {
   FILE *output = stdout;
@@ -30,8 +67,8 @@ void builtin_impl_console_log(Console::LogType log_ty, const char *msg) {
       output = stderr;
     }
   }
+  const char *prefix = nullptr;
   if (write_prefix) {
-    const char *prefix = "";
     switch (log_ty) {
     case Console::LogType::Log:
       prefix = "Log";
@@ -49,6 +86,23 @@ void builtin_impl_console_log(Console::LogType log_ty, const char *msg) {
       prefix = "Error";
       break;
     }
+  }
+
+  if (write_buffered && in_request) {
+    auto &buffer = output == stderr ? stderr_buffer : stdout_buffer;
+    if (prefix) {
+      buffer.append(prefix);
+      buffer.append(": ");
+    }
+    buffer.append(msg);
+    buffer.push_back('\n');
+    if (buffer.size() >= OUTPUT_BUFFER_FLUSH_BYTES) {
+      flush_output(output, buffer);
+    }
+    return;
+  }
+
+  if (prefix) {
     fprintf(output, "%s: %s\n", prefix, msg);
     fflush(output);
   } else {
@@ -61,15 +115,45 @@ void builtin_impl_console_log(Console::LogType log_ty, const char *msg) {
 
 namespace fastly::logger {
 
-bool Logger::log(JSContext *cx, unsigned argc, JS::Value *vp) {
-  METHOD_HEADER(1)
+namespace {
+
+// Records logged by buffered `Logger`s to an endpoint, separated by newlines, waiting to be
+// written to it in a single write.
+struct LogBuffer {
+  host_api::LogEndpoint::Handle endpoint;
+  std::string records;
+};
+
+std::vector<LogBuffer> log_buffers;
 
-  JS::RootedValue endpoint_id(cx, JS::GetReservedSlot(self, Slots::Endpoint));
+LogBuffer &log_buffer(host_api::LogEndpoint::Handle endpoint) {
+  for (auto &buffer : log_buffers) {
+    if (buffer.endpoint == endpoint) {
+      return buffer;
+    }
+  }
+  return log_buffers.emplace_back(LogBuffer{endpoint, {}});
+}
+
+host_api::Result<host_api::Void> flush_log_buffer(LogBuffer &buffer) {
+  if (buffer.records.empty()) {
+    host_api::Result<host_api::Void> res;
+    res.emplace();
+    return res;
+  }
+  auto res = host_api::LogEndpoint(buffer.endpoint).write(buffer.records);
+  buffer.records.clear();
+  return res;
+}
+
+// Opens the logger's endpoint if that hasn't happened yet, throwing any endpoint error for the
+// first log.
+bool open_endpoint(JSContext *cx, JS::HandleObject self, host_api::LogEndpoint *endpoint) {
+  JS::RootedValue endpoint_id(cx, JS::GetReservedSlot(self, Logger::Slots::Endpoint));
 
-  // If the endpoint has not yet been loaded up, do it now, throwing any endpoint error for the
-  // first log.
   if (endpoint_id.isNull()) {
-    JS::RootedString endpoint_name(cx, JS::GetReservedSlot(self, Slots::EndpointName).toString());
+    JS::RootedString endpoint_name(
+        cx, JS::GetReservedSlot(self, Logger::Slots::EndpointName).toString());
     auto endpoint_name_str = core::encode(cx, endpoint_name);
     if (!endpoint_name_str) {
       return false;
@@ -83,18 +167,219 @@ bool Logger::log(JSContext *cx, unsigned argc, JS::Value *vp) {
     }
 
     endpoint_id.set(JS::Int32Value(res.unwrap().handle));
-    JS::SetReservedSlot(self, Slots::Endpoint, endpoint_id);
+    JS::SetReservedSlot(self, Logger::Slots::Endpoint, endpoint_id);
 
     MOZ_ASSERT(endpoint_id.isInt32());
   }
 
-  host_api::LogEndpoint endpoint(endpoint_id.toInt32());
+  *endpoint = host_api::LogEndpoint(endpoint_id.toInt32());
+  return true;
+}
+
+// Set while a record is being serialized by `logRecord`, see there.
+bool serializing_record = false;
+
+// Reused by `logRecord` for records that are written right away.
+std::string record_scratch;
+
+bool is_buffering(JSObject *self) {
+  return JS::GetReservedSlot(self, Logger::Slots::Buffered).toBoolean() &&
+         builtins::web::console::in_request && !serializing_record;
+}
+
+bool flush_if_full(JSContext *cx, LogBuffer &buffer) {
+  if (buffer.records.size() < OUTPUT_BUFFER_FLUSH_BYTES) {
+    return true;
+  }
+  auto res = flush_log_buffer(buffer);
+  if (auto *err = res.to_err()) {
+    HANDLE_ERROR(cx, *err);
+    return false;
+  }
+  return true;
+}
+
+enum class RecordFormat { JSON, NDJSON, KV };
+
+// Appends the fragments JS::ToJSON produces to a string, transcoded to UTF-8 like the
+// `JSONBodyWriter` used by `Response.json` does.
+class JSONRecordWriter {
+public:
+  explicit JSONRecordWriter(std::string &out) : out_(out) {}
+
+  static bool write(const char16_t *str, uint32_t len, void *data) {
+    static_cast<JSONRecordWriter *>(data)->append(str, len);
+    return true;
+  }
+
+  // Serializes `val` as `JSON.stringify` would. Sets `serialized` to false if `val` has no JSON
+  // representation, such as `undefined` or a function.
+  bool serialize(JSContext *cx, JS::HandleValue val, bool *serialized) {
+    JS::RootedObject replacer(cx);
+    JS::RootedValue space(cx);
+    called_ = false;
+    if (!JS::ToJSON(cx, val, replacer, space, &JSONRecordWriter::write, this)) {
+      return false;
+    }
+    uint8_t tail[common::Utf16ToUtf8::max_length(0)];
+    out_.append(reinterpret_cast<char *>(tail), transcoder_.finish(tail));
+    *serialized = called_;
+    return true;
+  }
+
+private:
+  std::string &out_;
+  common::Utf16ToUtf8 transcoder_;
+  bool called_ = false;
+
+  void append(const char16_t *str, uint32_t len) {
+    called_ = true;
+    auto start = out_.size();
+    out_.resize(start + common::Utf16ToUtf8::max_length(len));
+    auto written =
+        transcoder_.transcode(str, len, reinterpret_cast<uint8_t *>(out_.data() + start));
+    out_.resize(start + written);
+  }
+};
+
+// Appends a key or string value in the kv format: as is if it's a non-empty string without
+// spaces, `=`, quotes or characters that need escaping, and as a quoted JSON string otherwise.
+bool write_kv_string(JSContext *cx, JSONRecordWriter &writer, std::string &out,
+                     JS::HandleValue str) {
+  auto start = out.size();
+  bool serialized;
+  if (!writer.serialize(cx, str, &serialized)) {
+    return false;
+  }
+  MOZ_ASSERT(serialized && out.size() >= start + 2);
+  std::string_view contents(out.data() + start + 1, out.size() - start - 2);
+  if (!contents.empty() && contents.find_first_of(" =\"\\") == std::string_view::npos) {
+    out.pop_back();
+    out.erase(start, 1);
+  }
+  return true;
+}
+
+// Appends the record's own enumerable properties as space-separated `key=value` pairs. Values that
+// aren't strings are written as JSON, and those without a JSON representation are skipped.
+bool write_kv_record(JSContext *cx, JS::HandleObject record, std::string &out) {
+  JS::Rooted<JS::IdVector> ids(cx, cx);
+  if (!JS_Enumerate(cx, record, &ids)) {
+    return false;
+  }
+
+  JSONRecordWriter writer(out);
+  JS::RootedValue key(cx);
+  JS::RootedValue value(cx);
+  bool first = true;
+  for (size_t i = 0; i < ids.length(); i++) {
+    if (!JS_GetPropertyById(cx, record, ids[i], &value)) {
+      return false;
+    }
+
+    auto pair_start = out.size();
+    if (!first) {
+      out.push_back(' ');
+    }
+    JSString *key_str = JS_IdToString(cx, ids[i]);
+    if (!key_str) {
+      return false;
+    }
+    key.setString(key_str);
+    if (!write_kv_string(cx, writer, out, key)) {
+      return false;
+    }
+    out.push_back('=');
+
+    if (value.isString()) {
+      if (!write_kv_string(cx, writer, out, value)) {
+        return false;
+      }
+    } else {
+      bool serialized;
+      if (!writer.serialize(cx, value, &serialized)) {
+        return false;
+      }
+      if (!serialized) {
+        out.resize(pair_start);
+        continue;
+      }
+    }
+    first = false;
+  }
+  return true;
+}
+
+bool serialize_record(JSContext *cx, JS::HandleValue record, RecordFormat format,
+                      std::string &out) {
+  if (format == RecordFormat::KV) {
+    JS::RootedObject record_obj(cx, &record.toObject());
+    return write_kv_record(cx, record_obj, out);
+  }
+
+  JSONRecordWriter writer(out);
+  bool serialized;
+  if (!writer.serialize(cx, record, &serialized)) {
+    return false;
+  }
+  if (!serialized) {
+    JS_ReportErrorUTF8(cx, "Logger.logRecord: record is not JSON serializable");
+    return false;
+  }
+  if (format == RecordFormat::NDJSON) {
+    out.push_back('\n');
+  }
+  return true;
+}
+
+// Writes out everything that has been buffered. There's no JS code to report errors to at this
+// point, so failed writes are reported on stderr.
+void flush_buffers() {
+  for (auto &buffer : log_buffers) {
+    if (flush_log_buffer(buffer).is_err()) {
+      fprintf(stderr, "Warning: Failed to write buffered records to a log endpoint.\n");
+    }
+  }
+  builtins::web::console::flush_console_output();
+}
+
+} // namespace
+
+void begin_request() { builtins::web::console::in_request = true; }
+
+void end_request() {
+  // The emptied buffers are kept for later requests, along with their capacity. Endpoint handles
+  // stay valid across requests, which is also why `Logger` keeps the one it opened.
+  flush_buffers();
+  builtins::web::console::in_request = false;
+}
+
+bool Logger::log(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(1)
+
+  host_api::LogEndpoint endpoint;
+  if (!open_endpoint(cx, self, &endpoint)) {
+    return false;
+  }
 
   auto msg = core::encode(cx, args.get(0));
   if (!msg) {
     return false;
   }
 
+  if (is_buffering(self)) {
+    auto &buffer = log_buffer(endpoint.handle);
+    if (!buffer.records.empty() && buffer.records.back() != '\n') {
+      buffer.records.push_back('\n');
+    }
+    buffer.records.append(msg.begin(), msg.len);
+    if (!flush_if_full(cx, buffer)) {
+      return false;
+    }
+    args.rval().setUndefined();
+    return true;
+  }
+
   auto res = endpoint.write(msg);
   if (auto *err = res.to_err()) {
     HANDLE_ERROR(cx, *err);
@@ -105,6 +390,99 @@ bool Logger::log(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
+bool Logger::logRecord(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(1)
+
+  auto format = RecordFormat::JSON;
+  JS::HandleValue options_val = args.get(1);
+  if (!options_val.isUndefined()) {
+    if (!options_val.isObject()) {
+      JS_ReportErrorUTF8(cx, "Logger.logRecord: options must be an object");
+      return false;
+    }
+    JS::RootedObject options(cx, &options_val.toObject());
+    JS::RootedValue format_val(cx);
+    if (!JS_GetProperty(cx, options, "format", &format_val)) {
+      return false;
+    }
+    if (!format_val.isUndefined()) {
+      host_api::HostString format_str;
+      if (format_val.isString()) {
+        format_str = core::encode(cx, format_val);
+        if (!format_str) {
+          return false;
+        }
+      }
+      std::string_view name = format_str ? std::string_view(format_str) : std::string_view();
+      if (name == "json") {
+        format = RecordFormat::JSON;
+      } else if (name == "ndjson") {
+        format = RecordFormat::NDJSON;
+      } else if (name == "kv") {
+        format = RecordFormat::KV;
+      } else {
+        JS_ReportErrorUTF8(cx,
+                           "Logger.logRecord: format option must be 'json', 'ndjson' or 'kv'");
+        return false;
+      }
+    }
+  }
+
+  JS::RootedValue record(cx, args.get(0));
+  if (format == RecordFormat::KV && !record.isObject()) {
+    JS_ReportErrorUTF8(cx, "Logger.logRecord: records logged in the kv format must be objects");
+    return false;
+  }
+
+  host_api::LogEndpoint endpoint;
+  if (!open_endpoint(cx, self, &endpoint)) {
+    return false;
+  }
+
+  // The record is serialized straight into the endpoint's buffer, or into a scratch buffer that's
+  // written right away. Serializing can run JS, such as `toJSON` methods, so anything logged
+  // meanwhile bypasses the buffers rather than ending up in the middle of this record.
+  bool was_serializing = serializing_record;
+  if (is_buffering(self)) {
+    auto &buffer = log_buffer(endpoint.handle);
+    auto start = buffer.records.size();
+    if (start > 0 && buffer.records.back() != '\n') {
+      buffer.records.push_back('\n');
+    }
+    serializing_record = true;
+    bool ok = serialize_record(cx, record, format, buffer.records);
+    serializing_record = was_serializing;
+    if (!ok) {
+      buffer.records.resize(start);
+      return false;
+    }
+    if (!flush_if_full(cx, buffer)) {
+      return false;
+    }
+    args.rval().setUndefined();
+    return true;
+  }
+
+  std::string nested_scratch;
+  auto &out = was_serializing ? nested_scratch : record_scratch;
+  out.clear();
+  serializing_record = true;
+  bool ok = serialize_record(cx, record, format, out);
+  serializing_record = was_serializing;
+  if (!ok) {
+    return false;
+  }
+
+  auto res = endpoint.write(out);
+  if (auto *err = res.to_err()) {
+    HANDLE_ERROR(cx, *err);
+    return false;
+  }
+
+  args.rval().setUndefined();
+  return true;
+}
+
 const JSFunctionSpec Logger::static_methods[] = {
     JS_FS_END,
 };
@@ -113,23 +491,51 @@ const JSPropertySpec Logger::static_properties[] = {
     JS_PS_END,
 };
 
-const JSFunctionSpec Logger::methods[] = {JS_FN("log", log, 1, JSPROP_ENUMERATE), JS_FS_END};
+const JSFunctionSpec Logger::methods[] = {JS_FN("log", log, 1, JSPROP_ENUMERATE),
+                                          JS_FN("logRecord", logRecord, 1, JSPROP_ENUMERATE),
+                                          JS_FS_END};
 
 const JSPropertySpec Logger::properties[] = {JS_PS_END};
 
-JSObject *Logger::create(JSContext *cx, JS::HandleValue endpoint_name) {
+JSObject *Logger::create(JSContext *cx, JS::HandleValue endpoint_name, bool buffered) {
   JS::RootedObject logger(cx, JS_NewObjectWithGivenProto(cx, &class_, proto_obj));
   if (!logger) {
     return nullptr;
   }
   JS::SetReservedSlot(logger, Slots::Endpoint, JS::NullValue());
   JS::SetReservedSlot(logger, Slots::EndpointName, endpoint_name);
+  JS::SetReservedSlot(logger, Slots::Buffered, JS::BooleanValue(buffered));
   return logger;
 }
 
 bool Logger::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
   CTOR_HEADER("Logger", 1);
-  auto logger = Logger::create(cx, args[0]);
+
+  bool buffered = false;
+  JS::HandleValue options_val = args.get(1);
+  if (!options_val.isUndefined()) {
+    if (!options_val.isObject()) {
+      JS_ReportErrorUTF8(cx, "Logger constructor: options must be an object");
+      return false;
+    }
+    JS::RootedObject options(cx, &options_val.toObject());
+    JS::RootedValue val(cx);
+    if (!JS_GetProperty(cx, options, "buffered", &val)) {
+      return false;
+    }
+    if (!val.isUndefined()) {
+      if (!val.isBoolean()) {
+        JS_ReportErrorUTF8(cx, "Logger constructor: buffered option must be a boolean");
+        return false;
+      }
+      buffered = val.toBoolean();
+    }
+  }
+
+  auto logger = Logger::create(cx, args[0], buffered);
+  if (!logger) {
+    return false;
+  }
   args.rval().setObject(*logger);
   return true;
 }
@@ -173,6 +579,21 @@ bool configure_console(JSContext *cx, unsigned argc, JS::Value *vp) {
     return false;
   }
 
+  // Handle buffered option
+  if (JS_GetProperty(cx, options, "buffered", &val)) {
+    if (!val.isUndefined()) {
+      if (!val.isBoolean()) {
+        JS_ReportErrorUTF8(cx, "buffered option must be a boolean");
+        return false;
+      }
+      // Output buffered so far is written out before the output streams can change.
+      builtins::web::console::flush_console_output();
+      builtins::web::console::write_buffered = val.toBoolean();
+    }
+  } else {
+    return false;
+  }
+
   // Set the return value to undefined
   args.rval().setUndefined();
   return true;
@@ -182,6 +603,7 @@ bool install(api::Engine *engine) {
   if (!Logger::init_class_impl(engine->cx(), engine->global())) {
     return false;
   }
+  host_api::add_event_loop_idle_hook(flush_buffers);
 
   RootedObject logger_ns_obj(engine->cx(), JS_NewObject(engine->cx(), nullptr));
   RootedValue logger_ns_val(engine->cx(), JS::ObjectValue(*logger_ns_obj));
@@ -9,21 +9,30 @@ namespace fastly::logger {
 class Logger : public builtins::BuiltinImpl<Logger> {
 private:
   static bool log(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool logRecord(JSContext *cx, unsigned argc, JS::Value *vp);
 
 public:
   static constexpr const char *class_name = "Logger";
   static const int ctor_length = 1;
 
-  enum Slots { Endpoint, EndpointName, Count };
+  enum Slots { Endpoint, EndpointName, Buffered, Count };
   static const JSFunctionSpec static_methods[];
   static const JSPropertySpec static_properties[];
   static const JSFunctionSpec methods[];
   static const JSPropertySpec properties[];
 
-  static JSObject *create(JSContext *cx, JS::HandleValue endpoint_name);
+  static JSObject *create(JSContext *cx, JS::HandleValue endpoint_name, bool buffered = false);
   static bool constructor(JSContext *cx, unsigned argc, JS::Value *vp);
 };
 
+/// Starts holding back the output of buffered `Logger`s, and of the console if it's configured to
+/// be buffered. Called when a request starts being handled.
+void begin_request();
+
+/// Writes out all buffered output, and stops buffering until the next request. Called once the
+/// request's event loop has finished.
+void end_request();
+
 } // namespace fastly::logger
 
 #endif
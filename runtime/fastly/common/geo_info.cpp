@@ -0,0 +1,309 @@
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "../host-api/host_api_fastly.h"
+#include "builtin.h"
+#include "extension-api.h"
+#include "geo_info.h"
+#include "host_api.h"
+#include "js/JSON.h"
+#include "lru_cache.h"
+
+namespace fastly::common {
+
+namespace {
+
+// The keys of the geolocation records returned by the host, in the order they're returned in.
+constexpr const char *KNOWN_KEYS[] = {
+    "as_name", "as_number", "area_code", "city", "conn_speed", "conn_type", "continent",
+    "country_code", "country_code3", "country_name", "gmt_offset", "latitude", "longitude",
+    "metro_code", "postal_code", "proxy_description", "proxy_type", "region", "utc_offset",
+};
+constexpr size_t KNOWN_KEY_COUNT = std::size(KNOWN_KEYS);
+
+// Pinned atoms for `KNOWN_KEYS`, so that building a result doesn't atomize its keys again.
+JSString *known_key_atoms[KNOWN_KEY_COUNT];
+bool known_key_atoms_initialized = false;
+
+bool init_known_key_atoms(JSContext *cx) {
+  if (known_key_atoms_initialized) {
+    return true;
+  }
+  for (size_t i = 0; i < KNOWN_KEY_COUNT; i++) {
+    known_key_atoms[i] = JS_AtomizeAndPinString(cx, KNOWN_KEYS[i]);
+    if (!known_key_atoms[i]) {
+      return false;
+    }
+  }
+  known_key_atoms_initialized = true;
+  return true;
+}
+
+using GeoValue = std::variant<std::monostate, bool, double, std::string>;
+
+struct GeoField {
+  // Index into `KNOWN_KEYS`, or `KNOWN_KEY_COUNT` if the key is only stored in `name`.
+  size_t known_key;
+  std::string name;
+  GeoValue value;
+};
+
+// A geolocation record. Records are flat objects of strings, numbers and nulls, which are decoded
+// into `fields` without going through a JS string and the JSON parser. Anything else is kept in
+// `json` for `JS_ParseJSON`.
+struct GeoRecord {
+  bool decoded;
+  std::vector<GeoField> fields;
+  std::string json;
+};
+
+constexpr size_t GEO_CACHE_MAX_ENTRIES = 1024;
+
+// Records by address, empty if there's no geolocation data for the address. Records only depend on
+// the address, so they are kept across the requests handled by a reusable sandbox.
+LruCache<std::optional<GeoRecord>> geo_cache(GEO_CACHE_MAX_ENTRIES);
+
+bool decode_record(std::string_view json, std::vector<GeoField> *fields) {
+  size_t pos = 0;
+  auto skip_whitespace = [&] {
+    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' ||
+                                 json[pos] == '\r')) {
+      pos++;
+    }
+  };
+  auto consume = [&](char c) {
+    skip_whitespace();
+    if (pos < json.size() && json[pos] == c) {
+      pos++;
+      return true;
+    }
+    return false;
+  };
+  auto consume_literal = [&](std::string_view literal) {
+    if (json.substr(pos, literal.size()) != literal) {
+      return false;
+    }
+    pos += literal.size();
+    return true;
+  };
+  auto consume_digits = [&] {
+    auto start = pos;
+    while (pos < json.size() && json[pos] >= '0' && json[pos] <= '9') {
+      pos++;
+    }
+    return pos > start;
+  };
+  // Strings containing escapes are left to the JSON parser.
+  auto read_string = [&](std::string_view *out) {
+    if (!consume('"')) {
+      return false;
+    }
+    auto start = pos;
+    while (pos < json.size() && json[pos] != '"') {
+      if (json[pos] == '\\' || static_cast<unsigned char>(json[pos]) < 0x20) {
+        return false;
+      }
+      pos++;
+    }
+    if (pos == json.size()) {
+      return false;
+    }
+    *out = json.substr(start, pos - start);
+    pos++;
+    return true;
+  };
+  auto read_number = [&](double *out) {
+    auto start = pos;
+    if (pos < json.size() && json[pos] == '-') {
+      pos++;
+    }
+    if (pos < json.size() && json[pos] == '0') {
+      pos++;
+    } else if (!consume_digits()) {
+      return false;
+    }
+    if (pos < json.size() && json[pos] == '.') {
+      pos++;
+      if (!consume_digits()) {
+        return false;
+      }
+    }
+    if (pos < json.size() && (json[pos] == 'e' || json[pos] == 'E')) {
+      pos++;
+      if (pos < json.size() && (json[pos] == '+' || json[pos] == '-')) {
+        pos++;
+      }
+      if (!consume_digits()) {
+        return false;
+      }
+    }
+    std::string number(json.substr(start, pos - start));
+    *out = std::strtod(number.c_str(), nullptr);
+    return true;
+  };
+  auto read_value = [&](GeoValue *out) {
+    skip_whitespace();
+    if (pos == json.size()) {
+      return false;
+    }
+    switch (json[pos]) {
+    case '"': {
+      std::string_view str;
+      if (!read_string(&str)) {
+        return false;
+      }
+      out->emplace<std::string>(str);
+      return true;
+    }
+    case 'n':
+      out->emplace<std::monostate>();
+      return consume_literal("null");
+    case 't':
+      out->emplace<bool>(true);
+      return consume_literal("true");
+    case 'f':
+      out->emplace<bool>(false);
+      return consume_literal("false");
+    default: {
+      double number;
+      if (!read_number(&number)) {
+        return false;
+      }
+      out->emplace<double>(number);
+      return true;
+    }
+    }
+  };
+
+  if (!consume('{')) {
+    return false;
+  }
+  if (!consume('}')) {
+    do {
+      std::string_view key;
+      GeoField field;
+      if (!read_string(&key) || !consume(':') || !read_value(&field.value)) {
+        return false;
+      }
+      field.known_key = 0;
+      while (field.known_key < KNOWN_KEY_COUNT && key != KNOWN_KEYS[field.known_key]) {
+        field.known_key++;
+      }
+      if (field.known_key == KNOWN_KEY_COUNT) {
+        field.name = key;
+      }
+      fields->push_back(std::move(field));
+    } while (consume(','));
+    if (!consume('}')) {
+      return false;
+    }
+  }
+  skip_whitespace();
+  return pos == json.size();
+}
+
+bool create_geo_info(JSContext *cx, const std::optional<GeoRecord> &record,
+                     JS::MutableHandleValue rval) {
+  if (!record) {
+    rval.setNull();
+    return true;
+  }
+
+  if (!record->decoded) {
+    JS::RootedString json(
+        cx, JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(record->json.data(), record->json.size())));
+    if (!json) {
+      return false;
+    }
+    return JS_ParseJSON(cx, json, rval);
+  }
+
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+  JS::RootedString key(cx);
+  JS::RootedId id(cx);
+  JS::RootedValue value(cx);
+  for (const auto &field : record->fields) {
+    if (field.known_key < KNOWN_KEY_COUNT) {
+      key = known_key_atoms[field.known_key];
+    } else {
+      key = JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(field.name.data(), field.name.size()));
+    }
+    if (!key || !JS_StringToId(cx, key, &id)) {
+      return false;
+    }
+
+    if (auto *boolean = std::get_if<bool>(&field.value)) {
+      value.setBoolean(*boolean);
+    } else if (auto *number = std::get_if<double>(&field.value)) {
+      value.setNumber(*number);
+    } else if (auto *str = std::get_if<std::string>(&field.value)) {
+      JSString *js_str = JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(str->data(), str->size()));
+      if (!js_str) {
+        return false;
+      }
+      value.setString(js_str);
+    } else {
+      value.setNull();
+    }
+
+    if (!JS_DefinePropertyById(cx, result, id, value, JSPROP_ENUMERATE)) {
+      return false;
+    }
+  }
+
+  rval.setObject(*result);
+  return true;
+}
+
+} // namespace
+
+bool get_geo_info(JSContext *cx, std::span<uint8_t> octets, bool report_host_errors,
+                  JS::MutableHandleValue rval) {
+  if (!init_known_key_atoms(cx)) {
+    return false;
+  }
+
+  std::string cache_key(reinterpret_cast<const char *>(octets.data()), octets.size());
+  if (auto *cached = geo_cache.find(cache_key)) {
+    return create_geo_info(cx, *cached, rval);
+  }
+
+  auto res = host_api::GeoIp::lookup(octets);
+  if (auto *err = res.to_err()) {
+    if (report_host_errors) {
+      HANDLE_ERROR(cx, *err);
+      return false;
+    }
+    rval.setNull();
+    return true;
+  }
+
+  std::optional<GeoRecord> record;
+  if (res.unwrap().has_value()) {
+    const auto &geo_json = res.unwrap().value();
+    std::string_view json(geo_json.ptr.get(), geo_json.len);
+    record.emplace();
+    record->decoded = decode_record(json, &record->fields);
+    if (!record->decoded) {
+      record->fields.clear();
+      record->json = json;
+    }
+  }
+
+  // Records the JSON parser rejects aren't cached, so the error is reported for every lookup.
+  if (!create_geo_info(cx, record, rval)) {
+    return false;
+  }
+
+  geo_cache.insert(std::move(cache_key), std::move(record));
+  return true;
+}
+
+} // namespace fastly::common
@@ -0,0 +1,22 @@
+#ifndef FASTLY_GEO_INFO_H
+#define FASTLY_GEO_INFO_H
+
+#include <span>
+
+#include "builtin.h"
+#include "extension-api.h"
+#include "host_api.h"
+
+namespace fastly::common {
+
+/// Sets `rval` to a new object with the geolocation data for the 4 or 16 IP address `octets`, or
+/// to null if there is none. Results are cached by address across the requests handled by a
+/// reusable sandbox.
+///
+/// If `report_host_errors` is false, a failed lookup is treated as there being no data.
+bool get_geo_info(JSContext *cx, std::span<uint8_t> octets, bool report_host_errors,
+                  JS::MutableHandleValue rval);
+
+} // namespace fastly::common
+
+#endif
@@ -0,0 +1,78 @@
+#include "lru_cache.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../builtins/fastly.h"
+
+using fastly::FastlyGetErrorMessage;
+
+namespace fastly::common {
+
+bool cache_options(JSContext *cx, JS::HandleValue options_val, const char *method,
+                   JS::MutableHandleObject options) {
+  if (options_val.isUndefined()) {
+    options.set(nullptr);
+    return true;
+  }
+  if (!options_val.isObject()) {
+    JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr, JSMSG_CACHE_OPTIONS_NOT_OBJECT,
+                              method);
+    return false;
+  }
+  options.set(&options_val.toObject());
+  return true;
+}
+
+bool cache_limit_option(JSContext *cx, JS::HandleObject options, const char *method,
+                        const char *name, size_t *value) {
+  if (!options) {
+    return true;
+  }
+  JS::RootedValue val(cx);
+  if (!JS_GetProperty(cx, options, name, &val)) {
+    return false;
+  }
+  if (val.isUndefined()) {
+    return true;
+  }
+  double limit;
+  if (!JS::ToNumber(cx, val, &limit)) {
+    return false;
+  }
+  if (!(limit >= 1) || limit > SIZE_MAX || std::floor(limit) != limit) {
+    JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr, JSMSG_CACHE_LIMIT_INVALID, method,
+                              name);
+    return false;
+  }
+  *value = static_cast<size_t>(limit);
+  return true;
+}
+
+bool cache_age_option(JSContext *cx, JS::HandleObject options, const char *method,
+                      const char *name, uint64_t *value_ns) {
+  if (!options) {
+    return true;
+  }
+  JS::RootedValue val(cx);
+  if (!JS_GetProperty(cx, options, name, &val)) {
+    return false;
+  }
+  if (val.isUndefined()) {
+    return true;
+  }
+  double age;
+  if (!JS::ToNumber(cx, val, &age)) {
+    return false;
+  }
+  if (!std::isfinite(age) || age < 0) {
+    JS_ReportErrorNumberASCII(cx, FastlyGetErrorMessage, nullptr, JSMSG_CACHE_AGE_INVALID, method,
+                              name);
+    return false;
+  }
+  // Anything beyond a few centuries is as good as forever, and has to be capped to fit anyway.
+  *value_ns = static_cast<uint64_t>(std::min(age * 1e6, static_cast<double>(UINT64_MAX / 2)));
+  return true;
+}
+
+} // namespace fastly::common
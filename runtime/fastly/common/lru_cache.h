@@ -0,0 +1,125 @@
+#ifndef FASTLY_LRU_CACHE_H
+#define FASTLY_LRU_CACHE_H
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "builtin.h"
+
+namespace fastly::common {
+
+/// A cache of values by string key, which evicts the least recently used entries once the total
+/// weight of its entries would exceed a maximum. Entries inserted with `insert` weigh 1, so the
+/// maximum is a number of entries unless `insert_weighted` is used.
+///
+/// Values are constructed in place and never moved, so they can hold rooted JS values.
+template <typename Value> class LruCache final {
+public:
+  explicit LruCache(size_t max_weight = 0) : max_weight_(max_weight) {}
+  LruCache(const LruCache &) = delete;
+  LruCache &operator=(const LruCache &) = delete;
+
+  size_t size() const { return entries_.size(); }
+  size_t weight() const { return weight_; }
+  size_t max_weight() const { return max_weight_; }
+  uint64_t evictions() const { return evictions_; }
+
+  void clear() {
+    index_.clear();
+    entries_.clear();
+    weight_ = 0;
+  }
+
+  /// Removes every entry and changes the maximum total weight.
+  void reset(size_t max_weight) {
+    clear();
+    max_weight_ = max_weight;
+  }
+
+  /// Returns the value cached for `key`, marking it as the most recently used, or nullptr.
+  Value *find(std::string_view key) {
+    auto found = index_.find(key);
+    if (found == index_.end()) {
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return &found->second->value;
+  }
+
+  void erase(std::string_view key) {
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+      erase(found->second);
+    }
+  }
+
+  /// Caches a value constructed from `args` for `key`, replacing any value already cached for it.
+  template <typename... Args> Value *insert(std::string key, Args &&...args) {
+    return insert_weighted(std::move(key), 1, std::forward<Args>(args)...);
+  }
+
+  /// Like `insert`, for an entry of the given weight. Returns nullptr, and only removes any value
+  /// already cached for `key`, if the entry weighs more than the maximum.
+  template <typename... Args>
+  Value *insert_weighted(std::string key, size_t weight, Args &&...args) {
+    erase(key);
+    if (weight > max_weight_) {
+      return nullptr;
+    }
+    while (weight_ + weight > max_weight_) {
+      erase(std::prev(entries_.end()));
+      evictions_++;
+    }
+    auto &entry = entries_.emplace_front(std::move(key), weight, std::forward<Args>(args)...);
+    index_.emplace(entry.key, entries_.begin());
+    weight_ += weight;
+    return &entry.value;
+  }
+
+private:
+  struct Entry {
+    std::string key;
+    size_t weight;
+    Value value;
+
+    template <typename... Args>
+    Entry(std::string key, size_t weight, Args &&...args)
+        : key(std::move(key)), weight(weight), value(std::forward<Args>(args)...) {}
+  };
+
+  void erase(typename std::list<Entry>::iterator entry) {
+    weight_ -= entry->weight;
+    index_.erase(entry->key);
+    entries_.erase(entry);
+  }
+
+  size_t max_weight_;
+  size_t weight_ = 0;
+  uint64_t evictions_ = 0;
+  // Most recently used first. The index refers to the keys stored in the entries.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string_view, typename std::list<Entry>::iterator> index_;
+};
+
+/// Reads the options object passed to an `enableCache` method, such as `ConfigStore.enableCache`,
+/// which may be undefined. Reports a TypeError naming `method` for anything else.
+bool cache_options(JSContext *cx, JS::HandleValue options_val, const char *method,
+                   JS::MutableHandleObject options);
+
+/// Sets `value` to the `name` option, if present, which must be a positive integer.
+bool cache_limit_option(JSContext *cx, JS::HandleObject options, const char *method,
+                        const char *name, size_t *value);
+
+/// Sets `value_ns` to the `name` option, if present, which must be a non-negative number of
+/// milliseconds.
+bool cache_age_option(JSContext *cx, JS::HandleObject options, const char *method,
+                      const char *name, uint64_t *value_ns);
+
+} // namespace fastly::common
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef FASTLY_UTF16_TO_UTF8_H
+#define FASTLY_UTF16_TO_UTF8_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fastly::common {
+
+/// Transcodes UTF-16 that arrives in fragments, such as the output of `JS::ToJSON`, to UTF-8. Lone
+/// surrogates are replaced with U+FFFD, as `core::encode` does.
+class Utf16ToUtf8 final {
+public:
+  /// The most bytes `transcode` writes for `len` code units.
+  static constexpr size_t max_length(size_t len) { return len * 3 + 3; }
+
+  /// Transcodes `len` code units to `out`, which must have room for `max_length(len)` bytes, and
+  /// returns the number of bytes written.
+  size_t transcode(const char16_t *str, size_t len, uint8_t *out) {
+    uint8_t *pos = out;
+    for (size_t i = 0; i < len; i++) {
+      char16_t c = str[i];
+      // A surrogate pair may be split across fragments, so a high surrogate is held back until
+      // the next code unit is known.
+      if (high_surrogate_) {
+        char16_t high = high_surrogate_;
+        high_surrogate_ = 0;
+        if (c >= 0xDC00 && c <= 0xDFFF) {
+          pos = put_code_point(0x10000 + ((high - 0xD800) << 10) + (c - 0xDC00), pos);
+          continue;
+        }
+        pos = put_code_point(0xFFFD, pos);
+      }
+      if (c >= 0xD800 && c <= 0xDBFF) {
+        high_surrogate_ = c;
+        continue;
+      }
+      pos = put_code_point(c >= 0xDC00 && c <= 0xDFFF ? 0xFFFD : c, pos);
+    }
+    return pos - out;
+  }
+
+  /// Ends the input, writing U+FFFD to `out`, which must have room for 3 bytes, if it ended with a
+  /// high surrogate. Returns the number of bytes written.
+  size_t finish(uint8_t *out) {
+    if (!high_surrogate_) {
+      return 0;
+    }
+    high_surrogate_ = 0;
+    return put_code_point(0xFFFD, out) - out;
+  }
+
+private:
+  char16_t high_surrogate_ = 0;
+
+  static uint8_t *put_code_point(uint32_t c, uint8_t *out) {
+    if (c < 0x80) {
+      *out++ = c;
+    } else if (c < 0x800) {
+      *out++ = 0xC0 | (c >> 6);
+      *out++ = 0x80 | (c & 0x3F);
+    } else if (c < 0x10000) {
+      *out++ = 0xE0 | (c >> 12);
+      *out++ = 0x80 | ((c >> 6) & 0x3F);
+      *out++ = 0x80 | (c & 0x3F);
+    } else {
+      *out++ = 0xF0 | (c >> 18);
+      *out++ = 0x80 | ((c >> 12) & 0x3F);
+      *out++ = 0x80 | ((c >> 6) & 0x3F);
+      *out++ = 0x80 | (c & 0x3F);
+    }
+    return out;
+  }
+};
+
+} // namespace fastly::common
+
+#endif
@@ -2,6 +2,7 @@
 #include "./builtins/backend.h"
 #include "./builtins/fastly.h"
 #include "./builtins/fetch-event.h"
+#include "./builtins/logger.h"
 #include "./host-api/fastly.h"
 #include "./host-api/host_api_fastly.h"
 #include "extension-api.h"
@@ -50,6 +51,7 @@ bool install(api::Engine *engine) {
 bool handle_incoming(host_api::Request req) {
   builtins::web::performance::Performance::timeOrigin.emplace(
       std::chrono::high_resolution_clock::now());
+  host_api::Profiler::reset();
 
   double total_compute = 0;
   std::chrono::system_clock::time_point start;
@@ -58,6 +60,7 @@ bool handle_incoming(host_api::Request req) {
   }
 
   __wasilibc_ensure_environ();
+  logger::begin_request();
 
   if (ENGINE->debug_logging_enabled()) {
     printf("Running JS handleRequest function for Fastly Compute service version %s\n",
@@ -71,11 +74,18 @@ bool handle_incoming(host_api::Request req) {
     return false;
   }
 
+  bool profiling = host_api::Profiler::enabled();
+  if (profiling) {
+    host_api::Profiler::begin_handler();
+  }
   if (ENGINE->debug_logging_enabled()) {
     fetch_event::dispatch_fetch_event(fetch_event, &total_compute);
   } else {
     fetch_event::dispatch_fetch_event(fetch_event);
   }
+  if (profiling) {
+    host_api::Profiler::end_handler();
+  }
 
   // Loop until no more resolved promises or backend requests are pending.
   if (ENGINE->debug_logging_enabled()) {
@@ -84,6 +94,7 @@ bool handle_incoming(host_api::Request req) {
   }
 
   bool success = ENGINE->run_event_loop();
+  logger::end_request();
 
   if (JS_IsExceptionPending(ENGINE->cx())) {
     ENGINE->dump_pending_exception("evaluating code");
@@ -120,8 +131,30 @@ bool handle_incoming(host_api::Request req) {
     double diff = duration_cast<microseconds>(end - start).count();
     printf("Done. Total request processing time: %fms. Total compute time: %fms\n", diff / 1000,
            total_compute / 1000);
+    auto arena = host_api::HostcallArena::stats();
+    printf("Hostcall arena: %zu bytes reserved, %zu bytes peak this request, %zu overflows\n",
+           arena.capacity, arena.request_peak_usage, arena.overflow_allocations);
+    auto select = host_api::async_select_stats();
+    printf("Event loop: %llu selects, %llu host selects, %llu ready checks, %llu tasks woken, "
+           "%llu served from the ready set\n",
+           static_cast<unsigned long long>(select.select_calls),
+           static_cast<unsigned long long>(select.host_selects),
+           static_cast<unsigned long long>(select.ready_checks),
+           static_cast<unsigned long long>(select.tasks_woken),
+           static_cast<unsigned long long>(select.ready_set_hits));
+    if (host_api::Profiler::enabled()) {
+      for (const auto &hostcall : host_api::Profiler::hostcalls()) {
+        if (hostcall.calls > 0) {
+          printf("Hostcall %s: %llu calls, %fms\n", hostcall.name.c_str(),
+                 static_cast<unsigned long long>(hostcall.calls),
+                 static_cast<double>(hostcall.nanoseconds) / 1000000);
+        }
+      }
+    }
   }
 
+  host_api::HostcallArena::reset();
+
   if (!restore_builtin_state()) {
     return false;
   }
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <chrono>
 #include <type_traits>
 
 #include "../../StarlingMonkey/runtime/allocator.h"
@@ -14,6 +15,81 @@
 using api::FastlyResult;
 using fastly::FastlyAPIError;
 
+namespace {
+
+struct ProfilerState {
+  bool enabled = false;
+  uint64_t handler_nanoseconds = 0;
+  // When the fetch event handler that's currently running started, if any.
+  std::optional<std::chrono::steady_clock::time_point> handler_start;
+  std::vector<host_api::Profiler::HostcallStats> hostcalls;
+};
+
+ProfilerState profiler;
+
+// Turns a `__PRETTY_FUNCTION__` signature into the function's qualified name, without the
+// `host_api::` namespace: "Result<HostString> host_api::HttpBody::read(uint32_t) const" becomes
+// "HttpBody::read".
+std::string hostcall_name(std::string_view signature) {
+  auto name = signature.substr(0, signature.find('('));
+  auto space = name.rfind(' ');
+  if (space != std::string_view::npos) {
+    name.remove_prefix(space + 1);
+  }
+  if (name.starts_with("host_api::")) {
+    name.remove_prefix(std::string_view("host_api::").size());
+  }
+  return std::string(name);
+}
+
+size_t register_hostcall(const char *signature) {
+  auto name = hostcall_name(signature);
+  for (size_t i = 0; i < profiler.hostcalls.size(); i++) {
+    if (profiler.hostcalls[i].name == name) {
+      return i;
+    }
+  }
+  profiler.hostcalls.push_back({.name = std::move(name)});
+  return profiler.hostcalls.size() - 1;
+}
+
+// Counts and times a call to a host API function for the profile, if profiling is enabled.
+class HostcallTimer final {
+  const char *signature_;
+  size_t *site_;
+  std::chrono::steady_clock::time_point start_;
+  bool active_;
+
+public:
+  HostcallTimer(const char *signature, size_t *site)
+      : signature_{signature}, site_{site}, active_{profiler.enabled} {
+    if (active_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+  ~HostcallTimer() {
+    if (!active_) {
+      return;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    if (*site_ == SIZE_MAX) {
+      *site_ = register_hostcall(signature_);
+    }
+    auto &stats = profiler.hostcalls[*site_];
+    stats.calls++;
+    stats.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  }
+  HostcallTimer(const HostcallTimer &) = delete;
+  HostcallTimer &operator=(const HostcallTimer &) = delete;
+};
+
+} // namespace
+
+// Each call site registers its function's profile entry on first use while profiling.
+#define PROFILE_HOSTCALL()                                                                         \
+  static size_t hostcall_site = SIZE_MAX;                                                          \
+  HostcallTimer hostcall_timer(__PRETTY_FUNCTION__, &hostcall_site);
+
 #if defined(DEBUG)
 static void log_hostcall(const char *func_name, ...) {
   std::stringstream ss;
@@ -34,16 +110,19 @@ static void log_hostcall(const char *func_name, ...) {
   va_end(args);
   fastly_push_debug_message(ss.str());
 }
-#define TRACE_CALL() log_hostcall(__func__);
-#define TRACE_CALL_ARGS(...) log_hostcall(__func__, __VA_ARGS__, nullptr);
+#define LOG_CALL() log_hostcall(__func__);
+#define LOG_CALL_ARGS(...) log_hostcall(__func__, __VA_ARGS__, nullptr);
 #define TRACE_CALL_RET(...) log_hostcall(__func__, std::string_view("-> "), __VA_ARGS__, nullptr);
 #define TSV(s) std::string_view(s)
 #else
-#define TRACE_CALL()
-#define TRACE_CALL_ARGS(...)
+#define LOG_CALL()
+#define LOG_CALL_ARGS(...)
 #define TRACE_CALL_RET(...)
 #endif
 
+#define TRACE_CALL() PROFILE_HOSTCALL() LOG_CALL()
+#define TRACE_CALL_ARGS(...) PROFILE_HOSTCALL() LOG_CALL_ARGS(__VA_ARGS__)
+
 #define NEVER_HANDLE 0xFFFFFFFD
 
 #define MILLISECS_IN_NANOSECS 1000000
@@ -112,112 +191,266 @@ void sleep_until(uint64_t time_ns, uint64_t now) {
   }
 }
 
+namespace {
+
+// The handles passed to the host by `select`, along with the index in the task list of the task
+// each one belongs to. These are kept across calls so that the event loop doesn't allocate a new
+// table on every turn, and so that a host index maps back to its task directly.
+std::vector<api::FastlyAsyncTask::Handle> select_handles;
+std::vector<size_t> select_task_indices;
+
+// Handles that an earlier call found to be ready, but didn't hand out yet, in the reverse of the
+// order in which they should be handed out. Polling every handle once and remembering all the
+// ready ones means that fan-outs with many concurrently completing tasks don't pay for a full
+// poll or select per task.
+std::vector<api::FastlyAsyncTask::Handle> ready_handles;
+
+host_api::AsyncSelectStats select_stats;
+
+// Timers are kept in a min-heap ordered by deadline, so that finding the soonest one doesn't take a
+// virtual `deadline()` call for every pending timer on every turn.
+//
+// The event loop's task list is only seen one `select` call at a time, so each task is given a
+// stamp when it's first seen. The list keeps its order when tasks are removed, and new tasks are
+// appended, so the list from the previous call is matched against the current one in a single
+// pass, and the stamps along the list are increasing. A task that can't be matched is treated as
+// new, so a timer that's re-armed, or a task allocated where a removed one was, gets a fresh
+// stamp and heap entry. Entries for timers that have run or been cleared are dropped lazily, once
+// they reach the top of the heap.
+struct TimerHeapEntry {
+  uint64_t deadline;
+  uint64_t stamp;
+
+  // Timers with the same deadline run in the order they were scheduled in.
+  bool operator>(const TimerHeapEntry &other) const {
+    return deadline != other.deadline ? deadline > other.deadline : stamp > other.stamp;
+  }
+};
+
+std::vector<TimerHeapEntry> timer_heap;
+std::vector<api::AsyncTask *> known_tasks;
+std::vector<uint64_t> known_stamps;
+std::vector<api::AsyncTask *> previous_tasks;
+std::vector<uint64_t> previous_stamps;
+size_t previous_task_idx = 0;
+uint64_t next_task_stamp = 1;
+size_t live_timers = 0;
+
+std::vector<void (*)()> event_loop_idle_hooks;
+
+void run_event_loop_idle_hooks() {
+  for (auto hook : event_loop_idle_hooks) {
+    hook();
+  }
+}
+
+bool async_is_ready(api::FastlyAsyncTask::Handle handle) {
+  fastly::fastly_host_error err = 0;
+  uint32_t is_ready_out;
+  select_stats.ready_checks++;
+  if (!convert_result(fastly::async_is_ready(handle, &is_ready_out), &err)) {
+    if (host_api::error_is_bad_handle(err)) {
+      fprintf(stderr, "Critical Error: An invalid handle was provided to async_is_ready.\n");
+    } else {
+      fprintf(stderr, "Critical Error: An unknown error occurred in async_is_ready.\n");
+    }
+    abort();
+  }
+  return is_ready_out;
+}
+
+// Hands out a previously found ready handle that still belongs to one of the current tasks,
+// returning its task index. The handle is checked again before it's handed out, as only the
+// handle's owner consuming its result makes it not ready anymore, but a single check is much
+// cheaper than a poll or select over all handles.
+std::optional<size_t> take_ready_task() {
+  while (!ready_handles.empty()) {
+    auto handle = ready_handles.back();
+    ready_handles.pop_back();
+    auto it = std::find(select_handles.begin(), select_handles.end(), handle);
+    if (it == select_handles.end()) {
+      continue;
+    }
+    if (async_is_ready(handle)) {
+      select_stats.ready_set_hits++;
+      return select_task_indices[it - select_handles.begin()];
+    }
+  }
+  return std::nullopt;
+}
+
+// Records `task` as the next task in the current list, matching it against the previous call's
+// list, and adds it to the timer heap if it's a timer that hasn't been seen before.
+void track_task(api::AsyncTask *task, uint32_t handle) {
+  uint64_t stamp = 0;
+  while (previous_task_idx < previous_tasks.size()) {
+    size_t idx = previous_task_idx++;
+    if (previous_tasks[idx] == task) {
+      stamp = previous_stamps[idx];
+      break;
+    }
+  }
+  if (stamp == 0) {
+    stamp = next_task_stamp++;
+    if (handle == NEVER_HANDLE) {
+      timer_heap.push_back({task->deadline(), stamp});
+      std::push_heap(timer_heap.begin(), timer_heap.end(), std::greater<>{});
+    }
+  }
+  if (handle == NEVER_HANDLE) {
+    live_timers++;
+  }
+  known_tasks.push_back(task);
+  known_stamps.push_back(stamp);
+}
+
+// Returns the index in the task list of the timer with the soonest deadline, if any, dropping the
+// heap entries of timers that are gone.
+std::optional<size_t> soonest_timer(uint64_t *deadline) {
+  MOZ_ASSERT(std::is_sorted(known_stamps.begin(), known_stamps.end()));
+  while (!timer_heap.empty()) {
+    const auto &top = timer_heap.front();
+    auto it = std::lower_bound(known_stamps.begin(), known_stamps.end(), top.stamp);
+    if (it != known_stamps.end() && *it == top.stamp) {
+      *deadline = top.deadline;
+      return it - known_stamps.begin();
+    }
+    std::pop_heap(timer_heap.begin(), timer_heap.end(), std::greater<>{});
+    timer_heap.pop_back();
+  }
+  return std::nullopt;
+}
+
+// Drops the entries of gone timers from the heap once they make up most of it, so that clearing
+// timers that never reach the top doesn't grow the heap without bound.
+void compact_timer_heap() {
+  if (timer_heap.size() <= 2 * live_timers + 64) {
+    return;
+  }
+  std::erase_if(timer_heap, [](const TimerHeapEntry &entry) {
+    return !std::binary_search(known_stamps.begin(), known_stamps.end(), entry.stamp);
+  });
+  std::make_heap(timer_heap.begin(), timer_heap.end(), std::greater<>{});
+}
+
+} // namespace
+
 size_t api::AsyncTask::select(std::vector<api::AsyncTask *> &tasks) {
+  PROFILE_HOSTCALL()
   if (tasks.size() == 0) {
-    TRACE_CALL()
+    LOG_CALL()
   } else {
     std::string arg0 = std::to_string(tasks.at(0)->handle_);
     if (tasks.size() == 1) {
-      TRACE_CALL_ARGS(TSV(arg0))
+      LOG_CALL_ARGS(TSV(arg0))
     } else {
       std::string arg1 = std::to_string(tasks.at(1)->handle_);
       if (tasks.size() == 2) {
-        TRACE_CALL_ARGS(TSV(arg0), TSV(arg1))
+        LOG_CALL_ARGS(TSV(arg0), TSV(arg1))
       } else {
         std::string arg2 = std::to_string(tasks.at(2)->handle_);
-        TRACE_CALL_ARGS(TSV(arg0), TSV(arg1), TSV(arg2))
+        LOG_CALL_ARGS(TSV(arg0), TSV(arg1), TSV(arg2))
       }
     }
   }
+  select_stats.select_calls++;
   size_t tasks_len = tasks.size();
-  std::vector<api::FastlyAsyncTask::Handle> handles;
-  handles.reserve(tasks_len);
-  uint64_t now = 0;
-  uint64_t soonest_deadline = 0;
-  size_t soonest_deadline_idx = -1;
+  select_handles.clear();
+  select_task_indices.clear();
+  previous_tasks.swap(known_tasks);
+  previous_stamps.swap(known_stamps);
+  known_tasks.clear();
+  known_stamps.clear();
+  previous_task_idx = 0;
+  live_timers = 0;
+  std::optional<size_t> first_immediate_idx;
   for (size_t idx = 0; idx < tasks_len; ++idx) {
     auto *task = tasks.at(idx);
-    uint64_t deadline;
-    if (task->id() == IMMEDIATE_TASK_HANDLE) {
-      if (now == 0) {
-        now = host_api::MonotonicClock::now();
-        MOZ_ASSERT(now > 0);
+    uint32_t handle = task->id();
+    track_task(task, handle);
+    if (handle == IMMEDIATE_TASK_HANDLE) {
+      if (!first_immediate_idx) {
+        first_immediate_idx = idx;
       }
-      deadline = now;
-    } else {
-      deadline = task->deadline();
+    } else if (handle != NEVER_HANDLE) {
+      // Only timer and immediate tasks have deadlines; everything else is passed to the host.
+      select_handles.push_back(handle);
+      select_task_indices.push_back(idx);
     }
-    if (deadline > 0) {
-      MOZ_ASSERT(task->id() == NEVER_HANDLE || task->id() == IMMEDIATE_TASK_HANDLE);
-      if (now == 0) {
-        now = host_api::MonotonicClock::now();
-        MOZ_ASSERT(now > 0);
-      }
+  }
+  compact_timer_heap();
+
+  uint64_t now = 0;
+  uint64_t soonest_deadline = 0;
+  size_t soonest_deadline_idx = -1;
+  uint64_t timer_deadline;
+  auto timer_idx = soonest_timer(&timer_deadline);
+  if (timer_idx || first_immediate_idx) {
+    now = host_api::MonotonicClock::now();
+    MOZ_ASSERT(now > 0);
+    if (timer_idx) {
       // expired timers treated as immediates
-      if (deadline < now) {
-        deadline = now;
-      }
-      // this check will always only select the first immediate
-      if (soonest_deadline == 0 || deadline < soonest_deadline) {
-        soonest_deadline = deadline;
-        soonest_deadline_idx = idx;
-      }
-    } else {
-      uint32_t handle = task->id();
-      // Timer and immediate task handles are skipped and never passed to the host.
-      MOZ_ASSERT(handle != NEVER_HANDLE && handle != IMMEDIATE_TASK_HANDLE);
-      handles.push_back(handle);
+      soonest_deadline = std::max(timer_deadline, now);
+      soonest_deadline_idx = *timer_idx;
+    }
+    // An immediate runs before the soonest timer, unless that timer has expired and was queued
+    // before the immediate.
+    if (first_immediate_idx &&
+        (!timer_idx || soonest_deadline > now || *first_immediate_idx < *timer_idx)) {
+      soonest_deadline = now;
+      soonest_deadline_idx = *first_immediate_idx;
     }
   }
 
   // When there are no async tasks, sleep until the deadline
-  if (handles.size() == 0) {
+  if (select_handles.size() == 0) {
+    ready_handles.clear();
     MOZ_ASSERT(soonest_deadline >= now);
+    if (soonest_deadline > now) {
+      run_event_loop_idle_hooks();
+    }
     sleep_until(soonest_deadline, now);
     return soonest_deadline_idx;
   }
 
+  // Handles found ready earlier are handed out first, just as a ready handle takes precedence over
+  // immediates and expired timers below.
+  if (auto task_idx = take_ready_task()) {
+    return *task_idx;
+  }
+
   uint32_t ret = UINT32_MAX;
   fastly::fastly_host_error err = 0;
 
   // only immediate timers in the task list -> do a ready check against all handles instead of a
-  // select
+  // select, remembering every ready handle for the following calls
   if (now != 0 && soonest_deadline == now) {
-    for (ret = 0; ret < handles.size(); ++ret) {
-      auto handle = handles.at(ret);
-      uint32_t is_ready_out;
-      if (!convert_result(fastly::async_is_ready(handle, &is_ready_out), &err)) {
-        if (host_api::error_is_bad_handle(err)) {
-          fprintf(stderr, "Critical Error: An invalid handle was provided to async_is_ready.\n");
-        } else {
-          fprintf(stderr, "Critical Error: An unknown error occurred in async_is_ready.\n");
-        }
-        abort();
-      };
-      if (is_ready_out) {
-        size_t task_idx = 0;
-        for (size_t idx = 0; idx < tasks_len; ++idx) {
-          uint32_t handle = tasks.at(idx)->id();
-          if (handle != NEVER_HANDLE && handle != IMMEDIATE_TASK_HANDLE) {
-            if (ret == task_idx) {
-              return idx;
-            }
-            task_idx++;
-          }
+    std::optional<size_t> first_ready;
+    for (size_t i = select_handles.size(); i-- > 0;) {
+      if (async_is_ready(select_handles[i])) {
+        select_stats.tasks_woken++;
+        if (first_ready) {
+          ready_handles.push_back(select_handles[*first_ready]);
         }
-        abort();
+        first_ready = i;
       }
     }
+    if (first_ready) {
+      return select_task_indices[*first_ready];
+    }
     // no tasks ready -> trigger our soonest immediate or timer
     return soonest_deadline_idx;
   }
 
+  run_event_loop_idle_hooks();
   while (true) {
     MOZ_ASSERT(soonest_deadline == 0 || soonest_deadline >= now);
     // timeout value of 0 means no timeout for async_select
     uint32_t timeout = soonest_deadline > 0 ? (soonest_deadline - now) / MILLISECS_IN_NANOSECS : 0;
-    if (!convert_result(fastly::async_select(handles.data(), handles.size(), timeout, &ret),
-                        &err)) {
+    select_stats.host_selects++;
+    if (!convert_result(
+            fastly::async_select(select_handles.data(), select_handles.size(), timeout, &ret),
+            &err)) {
       if (host_api::error_is_bad_handle(err)) {
         fprintf(stderr, "Critical Error: An invalid handle was provided to async_select.\n");
       } else {
@@ -228,20 +461,10 @@ size_t api::AsyncTask::select(std::vector<api::AsyncTask *> &tasks) {
 
     // The result is only valid if the timeout didn't expire.
     if (ret != UINT32_MAX) {
-      // The host index will be the index in the list of tasks with the timer tasks filtered out.
-      // We thus need to offset the host index by any timer tasks appearing before the nth
-      // non-timer task.
-      size_t task_idx = 0;
-      for (size_t idx = 0; idx < tasks_len; ++idx) {
-        uint32_t id = tasks.at(idx)->id();
-        if (id != NEVER_HANDLE && id != IMMEDIATE_TASK_HANDLE) {
-          if (ret == task_idx) {
-            return idx;
-          }
-          task_idx++;
-        }
-      }
-      abort();
+      // The host index is the index in the handle table, which records the task it came from.
+      MOZ_ASSERT(ret < select_task_indices.size());
+      select_stats.tasks_woken++;
+      return select_task_indices[ret];
     } else if (soonest_deadline > 0) {
       MOZ_ASSERT(soonest_deadline > now);
       MOZ_ASSERT(soonest_deadline_idx != -1);
@@ -263,6 +486,124 @@ namespace host_api {
 
 namespace {
 
+// The arena starts out large enough for a couple of maximum-size hostcall buffers, which covers
+// nested uses like reading a header's values while snapshotting a handle's headers.
+constexpr size_t HOSTCALL_ARENA_INITIAL_SIZE = 2 * HOSTCALL_BUFFER_LEN;
+// The most the arena keeps between requests. Requests that need more, such as those making
+// maximum-size body reads, get the rest from separate allocations that are freed as they're
+// released, rather than having every later request hold on to their peak.
+constexpr size_t HOSTCALL_ARENA_MAX_RETAINED_SIZE = 4 * HOSTCALL_BUFFER_LEN;
+
+struct HostcallArenaState {
+  std::unique_ptr<uint8_t[]> block;
+  size_t block_size = 0;
+  size_t used = 0;
+  std::vector<std::pair<std::unique_ptr<uint8_t[]>, size_t>> overflow;
+  size_t overflow_bytes = 0;
+  HostcallArena::Stats stats;
+};
+
+HostcallArenaState hostcall_arena;
+
+} // namespace
+
+HostcallArena::Scope::Scope()
+    : mark_{hostcall_arena.used}, overflow_mark_{hostcall_arena.overflow.size()} {}
+
+HostcallArena::Scope::~Scope() {
+  auto &arena = hostcall_arena;
+  MOZ_ASSERT(arena.used >= mark_ && arena.overflow.size() >= overflow_mark_);
+  arena.used = mark_;
+  // Overflow allocations are only ever made while the block is full, so they are freed rather
+  // than kept around: the block is grown to fit them, up to its retained size, on the next reset.
+  while (arena.overflow.size() > overflow_mark_) {
+    arena.overflow_bytes -= arena.overflow.back().second;
+    arena.overflow.pop_back();
+  }
+}
+
+uint8_t *HostcallArena::Scope::alloc(size_t len) {
+  auto &arena = hostcall_arena;
+  size_t aligned_len = (len + 7) & ~static_cast<size_t>(7);
+  if (!arena.block) {
+    arena.block_size = std::clamp(aligned_len, HOSTCALL_ARENA_INITIAL_SIZE,
+                                  HOSTCALL_ARENA_MAX_RETAINED_SIZE);
+    arena.block.reset(new uint8_t[arena.block_size]);
+    arena.stats.capacity = arena.block_size;
+  }
+
+  uint8_t *ptr;
+  if (arena.block_size - arena.used >= aligned_len) {
+    ptr = arena.block.get() + arena.used;
+    arena.used += aligned_len;
+  } else {
+    ptr = arena.overflow.emplace_back(new uint8_t[aligned_len], aligned_len).first.get();
+    arena.overflow_bytes += aligned_len;
+    arena.stats.overflow_allocations++;
+  }
+
+  size_t usage = arena.used + arena.overflow_bytes;
+  arena.stats.request_peak_usage = std::max(arena.stats.request_peak_usage, usage);
+  arena.stats.peak_usage = std::max(arena.stats.peak_usage, usage);
+  return ptr;
+}
+
+size_t HostcallArena::max_retained_size() { return HOSTCALL_ARENA_MAX_RETAINED_SIZE; }
+
+void HostcallArena::reset() {
+  auto &arena = hostcall_arena;
+  MOZ_ASSERT(arena.used == 0 && arena.overflow.empty());
+  size_t block_size = std::min(arena.stats.request_peak_usage, HOSTCALL_ARENA_MAX_RETAINED_SIZE);
+  if (block_size > arena.block_size) {
+    arena.block_size = block_size;
+    arena.block.reset(new uint8_t[arena.block_size]);
+    arena.stats.capacity = arena.block_size;
+  }
+  arena.used = 0;
+  arena.overflow.clear();
+  arena.overflow_bytes = 0;
+  arena.stats.request_peak_usage = 0;
+}
+
+HostcallArena::Stats HostcallArena::stats() { return hostcall_arena.stats; }
+
+AsyncSelectStats async_select_stats() { return select_stats; }
+
+void add_event_loop_idle_hook(void (*hook)()) { event_loop_idle_hooks.push_back(hook); }
+
+bool Profiler::enabled() { return profiler.enabled; }
+
+void Profiler::set_enabled(bool enabled) { profiler.enabled = enabled; }
+
+void Profiler::begin_handler() { profiler.handler_start = std::chrono::steady_clock::now(); }
+
+void Profiler::end_handler() {
+  profiler.handler_nanoseconds = handler_nanoseconds();
+  profiler.handler_start.reset();
+}
+
+uint64_t Profiler::handler_nanoseconds() {
+  if (!profiler.handler_start) {
+    return profiler.handler_nanoseconds;
+  }
+  auto running = std::chrono::steady_clock::now() - *profiler.handler_start;
+  return profiler.handler_nanoseconds +
+         std::chrono::duration_cast<std::chrono::nanoseconds>(running).count();
+}
+
+const std::vector<Profiler::HostcallStats> &Profiler::hostcalls() { return profiler.hostcalls; }
+
+void Profiler::reset() {
+  profiler.handler_nanoseconds = 0;
+  profiler.handler_start.reset();
+  for (auto &stats : profiler.hostcalls) {
+    stats.calls = 0;
+    stats.nanoseconds = 0;
+  }
+}
+
+namespace {
+
 fastly::fastly_world_list_u8 span_to_list_u8(std::span<uint8_t> span) {
   return {
       .ptr = const_cast<uint8_t *>(span.data()),
@@ -293,74 +634,6 @@ Response make_response(fastly::fastly_host_http_response &resp) {
   return Response{HttpResp{resp.f0}, HttpBody{resp.f1}};
 }
 
-template <auto header_names_get>
-Result<std::vector<HostString>> generic_get_header_names(auto handle) {
-  Result<std::vector<HostString>> res;
-
-  fastly::fastly_world_list_string ret;
-  fastly::fastly_host_error err;
-  fastly::fastly_world_string *strs = static_cast<fastly::fastly_world_string *>(
-      cabi_malloc(LIST_ALLOC_SIZE * sizeof(fastly::fastly_world_string), 1));
-  size_t str_max = LIST_ALLOC_SIZE;
-  size_t str_cnt = 0;
-  size_t nwritten;
-  uint8_t *buf = static_cast<uint8_t *>(cabi_malloc(HOSTCALL_BUFFER_LEN, 1));
-  uint32_t cursor = 0;
-  int64_t next_cursor = 0;
-  while (true) {
-    if (!convert_result(
-            header_names_get(handle, buf, HEADER_MAX_LEN, cursor, &next_cursor, &nwritten), &err)) {
-      cabi_free(buf);
-      cabi_free(strs);
-      res.emplace_err(err);
-      return res;
-    }
-    if (nwritten == 0) {
-      break;
-    }
-    uint32_t offset = 0;
-    for (size_t i = 0; i < nwritten; i++) {
-      if (buf[i] != '\0')
-        continue;
-      if (str_cnt == str_max) {
-        strs = static_cast<fastly::fastly_world_string *>(
-            cabi_realloc(strs, str_max * sizeof(fastly::fastly_world_string), 1,
-                         (str_max + LIST_ALLOC_SIZE) * sizeof(fastly::fastly_world_string)));
-        str_max += LIST_ALLOC_SIZE;
-      }
-      size_t len = i - offset;
-      strs[str_cnt].ptr = static_cast<uint8_t *>(cabi_malloc(len, 1));
-      strs[str_cnt].len = len;
-      memcpy(strs[str_cnt].ptr, buf + offset, len);
-      offset = i + 1;
-      str_cnt++;
-    }
-    if (next_cursor < 0)
-      break;
-    cursor = (uint32_t)next_cursor;
-  }
-  cabi_free(buf);
-  if (str_cnt != 0) {
-    strs = static_cast<fastly::fastly_world_string *>(
-        cabi_realloc(strs, str_max * sizeof(fastly::fastly_world_string), 1,
-                     str_cnt * sizeof(fastly::fastly_world_string)));
-  }
-  ret.ptr = strs;
-  ret.len = str_cnt;
-  std::vector<HostString> names;
-
-  for (int i = 0; i < ret.len; i++) {
-    names.emplace_back(make_host_string(ret.ptr[i]));
-  }
-
-  // Free the vector of string pointers, but leave the individual strings alone.
-  cabi_free(ret.ptr);
-
-  res.emplace(std::move(names));
-
-  return res;
-}
-
 struct Chunk {
   JS::UniqueChars buffer;
   size_t length;
@@ -381,14 +654,14 @@ Result<std::optional<std::vector<HostString>>> generic_get_header_values(auto ha
   fastly::fastly_world_option_list_list_u8 ret;
   fastly::fastly_host_error err;
   std::vector<Chunk> header_values;
-  JS::UniqueLatin1Chars buffer(static_cast<unsigned char *>(cabi_malloc(HEADER_MAX_LEN, 1)));
+  HostcallArena::Scope scratch;
+  uint8_t *buffer = scratch.alloc(HEADER_MAX_LEN);
   uint32_t cursor = 0;
   while (true) {
     int64_t ending_cursor = 0;
     size_t length = 0;
     if (!convert_result(header_values_get(handle, reinterpret_cast<char *>(hdr.ptr), hdr.len,
-                                          buffer.get(), HEADER_MAX_LEN, cursor, &ending_cursor,
-                                          &length),
+                                          buffer, HEADER_MAX_LEN, cursor, &ending_cursor, &length),
                         &err)) {
       res.emplace_err(err);
       return res;
@@ -398,7 +671,7 @@ Result<std::optional<std::vector<HostString>>> generic_get_header_values(auto ha
       break;
     }
 
-    std::string_view result{reinterpret_cast<char *>(buffer.get()), length};
+    std::string_view result{reinterpret_cast<char *>(buffer), length};
     while (!result.empty()) {
       auto end = result.find('\0');
       header_values.emplace_back(Chunk::make(result.substr(0, end)));
@@ -448,6 +721,95 @@ Result<std::optional<std::vector<HostString>>> generic_get_header_values(auto ha
   return res;
 }
 
+// Fetches every header name and value on a handle in one pass.
+//
+// A single scratch buffer serves all of the names and values hostcalls, and everything they return
+// is decoded into one arena, referenced by offset, rather than into a separately allocated string
+// per name and per value. The only per-entry allocations left are the final HostStrings, which the
+// StarlingMonkey headers list requires to own their data.
+template <auto header_names_get, auto header_values_get>
+Result<std::vector<std::tuple<HostString, HostString>>> generic_get_header_entries(auto handle) {
+  using Entries = std::vector<std::tuple<HostString, HostString>>;
+
+  HostcallArena::Scope scope;
+  uint8_t *scratch = scope.alloc(HEADER_MAX_LEN);
+  std::string arena;
+  // (offset, length) of each header name in the arena.
+  std::vector<std::pair<size_t, size_t>> names;
+  // (name index, offset, length) of each header value in the arena.
+  std::vector<std::tuple<size_t, size_t, size_t>> values;
+  fastly::fastly_host_error err;
+
+  uint32_t cursor = 0;
+  while (true) {
+    int64_t next_cursor = 0;
+    size_t nwritten = 0;
+    if (!convert_result(
+            header_names_get(handle, scratch, HEADER_MAX_LEN, cursor, &next_cursor, &nwritten),
+            &err)) {
+      return Result<Entries>::err(err);
+    }
+    if (nwritten == 0) {
+      break;
+    }
+    std::string_view buf{reinterpret_cast<char *>(scratch), nwritten};
+    size_t offset = 0;
+    for (size_t end = buf.find('\0'); end != buf.npos; end = buf.find('\0', offset)) {
+      names.emplace_back(arena.size(), end - offset);
+      arena.append(buf.substr(offset, end - offset));
+      offset = end + 1;
+    }
+    if (next_cursor < 0) {
+      break;
+    }
+    cursor = static_cast<uint32_t>(next_cursor);
+  }
+
+  for (size_t name_idx = 0; name_idx < names.size(); name_idx++) {
+    auto [name_offset, name_len] = names[name_idx];
+    uint32_t values_cursor = 0;
+    while (true) {
+      int64_t ending_cursor = 0;
+      size_t length = 0;
+      // The arena may have been reallocated by earlier values, so the name pointer is taken anew
+      // for each call.
+      if (!convert_result(header_values_get(handle, arena.data() + name_offset, name_len,
+                                            scratch, HEADER_MAX_LEN, values_cursor,
+                                            &ending_cursor, &length),
+                          &err)) {
+        return Result<Entries>::err(err);
+      }
+      if (length == 0) {
+        break;
+      }
+      std::string_view result{reinterpret_cast<char *>(scratch), length};
+      while (!result.empty()) {
+        auto end = result.find('\0');
+        auto value = result.substr(0, end);
+        values.emplace_back(name_idx, arena.size(), value.size());
+        arena.append(value);
+        if (end == result.npos) {
+          break;
+        }
+        result = result.substr(end + 1);
+      }
+      if (ending_cursor < 0) {
+        break;
+      }
+      values_cursor = static_cast<uint32_t>(ending_cursor);
+    }
+  }
+
+  Entries entries;
+  entries.reserve(values.size());
+  for (auto [name_idx, value_offset, value_len] : values) {
+    auto [name_offset, name_len] = names[name_idx];
+    entries.emplace_back(HostString(std::string_view(arena.data() + name_offset, name_len)),
+                         HostString(std::string_view(arena.data() + value_offset, value_len)));
+  }
+  return Result<Entries>::ok(std::move(entries));
+}
+
 template <auto header_op>
 Result<Void> generic_header_op(auto handle, std::string_view name, std::span<uint8_t> value) {
   Result<Void> res;
@@ -572,45 +934,14 @@ const std::vector<const char *> &HttpHeaders::get_forbidden_response_headers() {
 
 Result<vector<tuple<HostString, HostString>>> HttpHeadersReadOnly::entries() const {
   TRACE_CALL()
-  Result<vector<tuple<HostString, HostString>>> res;
-
-  Result<std::vector<HostString>> names_res;
   if (this->handle_state_.get()->is_req()) {
-    names_res =
-        generic_get_header_names<fastly::req_header_names_get>(this->handle_state_.get()->handle());
+    return generic_get_header_entries<fastly::req_header_names_get, fastly::req_header_values_get>(
+        this->handle_state_.get()->handle());
   } else {
-    names_res = generic_get_header_names<fastly::resp_header_names_get>(
+    return generic_get_header_entries<fastly::resp_header_names_get,
+                                      fastly::resp_header_values_get>(
         this->handle_state_.get()->handle());
   }
-  if (const auto err = names_res.to_err()) {
-    return Result<vector<tuple<HostString, HostString>>>::err(*err);
-  }
-
-  vector<tuple<HostString, HostString>> entries_vec;
-  for (auto &name : names_res.unwrap()) {
-    auto values_res = HttpHeadersReadOnly::get(name);
-    if (auto err = values_res.to_err()) {
-      return Result<vector<tuple<HostString, HostString>>>::err(*err);
-    }
-    auto &values = values_res.unwrap();
-    if (!values.has_value()) {
-      // original js-compute-runtime also skipped here, but should this be an error or empty entry?
-      continue;
-    }
-    auto &vals = values.value();
-    auto *last_val = vals.data() + vals.size();
-    for (auto &value : vals) {
-      if (&value + 1 == last_val) {
-        entries_vec.emplace_back(std::move(name), std::move(value));
-      } else {
-        std::string_view host_name_view(name);
-        entries_vec.emplace_back(host_api::HostString(host_name_view), std::move(value));
-      }
-    }
-  }
-
-  res.emplace(std::move(entries_vec));
-  return res;
 }
 
 Result<optional<vector<HostString>>> HttpHeadersReadOnly::get(string_view name) const {
@@ -678,23 +1009,62 @@ Result<HttpHeaders *> HttpHeaders::FromEntries(vector<tuple<HostString, HostStri
 // Instead, we use write_headers to write into an existing headers object.
 Result<Void>
 write_headers(HttpHeaders *headers,
-              std::vector<std::tuple<host_api::HostString, host_api::HostString>> &list) {
+              std::vector<std::tuple<host_api::HostString, host_api::HostString>> &list,
+              CommittedHeaders *committed) {
   TRACE_CALL()
-  std::vector<std::string_view> seen;
-  seen.reserve(list.size());
-  host_api::Result<host_api::Void> res;
+  // Group the values by name, keeping the order in which the names first appear.
+  std::vector<std::string_view> names;
+  std::unordered_map<std::string_view, std::vector<std::string_view>> values;
+  values.reserve(list.size());
   for (const auto &[name, value] : list) {
-    if (std::find(seen.begin(), seen.end(), name) == seen.end()) {
-      // first time seeing a header -> use set in case of existing values on the handle
-      res = headers->set(name, value);
-      seen.push_back(name);
-    } else {
-      // seen before -> use append
-      res = headers->append(name, value);
+    std::string_view name_view = name;
+    auto [entry, inserted] = values.try_emplace(name_view);
+    if (inserted) {
+      names.push_back(name_view);
+    }
+    entry->second.emplace_back(value);
+  }
+
+  host_api::Result<host_api::Void> res;
+  if (committed) {
+    for (auto entry = committed->begin(); entry != committed->end();) {
+      if (values.find(entry->first) != values.end()) {
+        ++entry;
+        continue;
+      }
+      res = headers->remove(entry->first);
+      if (res.is_err()) {
+        return res;
+      }
+      entry = committed->erase(entry);
+    }
+  }
+
+  for (auto name : names) {
+    const auto &name_values = values[name];
+    if (committed) {
+      auto entry = committed->find(std::string(name));
+      if (entry != committed->end() &&
+          std::equal(entry->second.begin(), entry->second.end(), name_values.begin(),
+                     name_values.end())) {
+        continue;
+      }
+    }
+    // use set for the first value in case of existing values on the handle, then append the rest
+    res = headers->set(name, name_values.front());
+    for (size_t i = 1; !res.is_err() && i < name_values.size(); i++) {
+      res = headers->append(name, name_values[i]);
     }
     if (res.is_err()) {
+      // The handle's values for this name are now unknown, so make sure the next write sets them.
+      if (committed) {
+        committed->erase(std::string(name));
+      }
       return res;
     }
+    if (committed) {
+      (*committed)[std::string(name)].assign(name_values.begin(), name_values.end());
+    }
   }
   return Result<Void>::ok();
 }
@@ -998,11 +1368,36 @@ Result<size_t> HttpBody::read_into(uint8_t *ptr, size_t chunk_size) const {
   return res;
 }
 
-constexpr size_t HANDLE_READ_CHUNK_SIZE = 8192;
+BodyReadSizer::BodyReadSizer(size_t chunk_size, size_t max_chunk_size)
+    : max_chunk_size_{std::max(max_chunk_size, MIN_CHUNK_SIZE)} {
+  chunk_size_ = std::clamp(chunk_size, MIN_CHUNK_SIZE, max_chunk_size_);
+}
+
+BodyReadSizer BodyReadSizer::for_body(const HttpBody &body, size_t max_chunk_size) {
+  auto length_res = body.known_length();
+  if (length_res.is_err() || !length_res.unwrap().has_value()) {
+    return BodyReadSizer(MIN_CHUNK_SIZE, max_chunk_size);
+  }
+  uint64_t length = length_res.unwrap().value();
+  BodyReadSizer sizer(length > SIZE_MAX ? SIZE_MAX : static_cast<size_t>(length), max_chunk_size);
+  sizer.known_length_ = length;
+  return sizer;
+}
+
+void BodyReadSizer::record(size_t bytes_read) {
+  if (bytes_read < chunk_size_) {
+    return;
+  }
+  chunk_size_ = chunk_size_ > max_chunk_size_ / 2 ? max_chunk_size_ : chunk_size_ * 2;
+}
 
 Result<HostBytes> HttpBody::read_all() const {
   Result<HostBytes> res;
-  size_t buf_cap = HANDLE_READ_CHUNK_SIZE;
+  // We own the whole destination buffer here, so reads are not capped: a body with a known length
+  // is read into a single allocation sized to fit it, plus one byte so that the final
+  // end-of-stream read doesn't force a reallocation.
+  auto sizer = BodyReadSizer::for_body(*this, SIZE_MAX);
+  size_t buf_cap = sizer.chunk_size() + (sizer.known_length().has_value() ? 1 : 0);
   size_t buf_len = 0;
   uint8_t *buf = static_cast<uint8_t *>(malloc(buf_cap));
   if (!buf) {
@@ -1010,8 +1405,13 @@ Result<HostBytes> HttpBody::read_all() const {
     return res;
   }
   do {
-    if (buf_len + HANDLE_READ_CHUNK_SIZE > buf_cap) {
-      buf_cap *= 2;
+    if (buf_len == buf_cap) {
+      if (sizer.chunk_size() > SIZE_MAX - buf_cap) {
+        free(buf);
+        res.emplace_err(FASTLY_HOST_ERROR_GENERIC_ERROR);
+        return res;
+      }
+      buf_cap += sizer.chunk_size();
       uint8_t *new_buf = static_cast<uint8_t *>(realloc(buf, buf_cap));
       if (!new_buf) {
         free(buf);
@@ -1020,7 +1420,8 @@ Result<HostBytes> HttpBody::read_all() const {
       }
       buf = new_buf;
     }
-    host_api::Result<size_t> chunk = this->read_into((buf + buf_len), HANDLE_READ_CHUNK_SIZE);
+    size_t chunk_size = std::min(sizer.chunk_size(), buf_cap - buf_len);
+    host_api::Result<size_t> chunk = this->read_into((buf + buf_len), chunk_size);
     if (auto *err = chunk.to_err()) {
       free(buf);
       res.emplace_err(*err);
@@ -1031,12 +1432,13 @@ Result<HostBytes> HttpBody::read_all() const {
       if (buf_len == 0) {
         free(buf);
         buf = nullptr;
-      } else {
+      } else if (buf_len < buf_cap) {
         buf = static_cast<uint8_t *>(realloc(buf, buf_len));
       }
       break;
     }
     buf_len += len;
+    sizer.record(len);
   } while (true);
   res.emplace(make_host_bytes(buf, buf_len));
   return res;
@@ -1589,16 +1991,13 @@ Result<HostString> HttpReq::get_method() const {
   Result<HostString> res;
 
   fastly::fastly_host_error err;
-  fastly::fastly_world_string method;
-  method.ptr = static_cast<uint8_t *>(cabi_malloc(METHOD_MAX_LEN, 1));
-  if (!convert_result(fastly::req_method_get(this->handle, reinterpret_cast<char *>(method.ptr),
-                                             METHOD_MAX_LEN, &method.len),
-                      &err)) {
-    cabi_free(method.ptr);
+  HostcallArena::Scope scratch;
+  auto *buf = reinterpret_cast<char *>(scratch.alloc(METHOD_MAX_LEN));
+  size_t len;
+  if (!convert_result(fastly::req_method_get(this->handle, buf, METHOD_MAX_LEN, &len), &err)) {
     res.emplace_err(err);
   } else {
-    method.ptr = static_cast<uint8_t *>(cabi_realloc(method.ptr, METHOD_MAX_LEN, 1, method.len));
-    res.emplace(make_host_string(method));
+    res.emplace(HostString(std::string_view(buf, len)));
   }
 
   return res;
@@ -1625,16 +2024,13 @@ Result<HostString> HttpReq::get_uri() const {
   Result<HostString> res;
 
   fastly::fastly_host_error err;
-  fastly::fastly_world_string uri;
-  uri.ptr = static_cast<uint8_t *>(cabi_malloc(URI_MAX_LEN, 1));
-  if (!convert_result(fastly::req_uri_get(this->handle, reinterpret_cast<char *>(uri.ptr),
-                                          URI_MAX_LEN, &uri.len),
-                      &err)) {
-    cabi_free(uri.ptr);
+  HostcallArena::Scope scratch;
+  auto *buf = reinterpret_cast<char *>(scratch.alloc(URI_MAX_LEN));
+  size_t len;
+  if (!convert_result(fastly::req_uri_get(this->handle, buf, URI_MAX_LEN, &len), &err)) {
     res.emplace_err(err);
   } else {
-    uri.ptr = static_cast<uint8_t *>(cabi_realloc(uri.ptr, URI_MAX_LEN, 1, uri.len));
-    res.emplace(make_host_string(uri));
+    res.emplace(HostString(std::string_view(buf, len)));
   }
 
   return res;
@@ -2344,26 +2740,23 @@ Result<std::optional<HostString>> GeoIp::lookup(std::span<uint8_t> bytes) {
   Result<std::optional<HostString>> res;
 
   fastly::fastly_world_list_u8 octets_list{const_cast<uint8_t *>(bytes.data()), bytes.size()};
-  fastly::fastly_world_string ret;
   fastly::fastly_host_error err;
-  ret.ptr = static_cast<uint8_t *>(cabi_malloc(HOSTCALL_BUFFER_LEN, 1));
-  if (!convert_result(fastly::geo_lookup(octets_list.ptr, octets_list.len,
-                                         reinterpret_cast<char *>(ret.ptr), HOSTCALL_BUFFER_LEN,
-                                         &ret.len),
-                      &err)) {
-    cabi_free(ret.ptr);
+  HostcallArena::Scope scratch;
+  auto *buf = reinterpret_cast<char *>(scratch.alloc(HOSTCALL_BUFFER_LEN));
+  size_t len;
+  if (!convert_result(
+          fastly::geo_lookup(octets_list.ptr, octets_list.len, buf, HOSTCALL_BUFFER_LEN, &len),
+          &err)) {
     if (error_is_optional_none(err)) {
       res.emplace(std::nullopt);
     } else {
       res.emplace_err(err);
     }
-  } else if (ret.len == 0) {
+  } else if (len == 0) {
     // Viceroy returns a zero len instead of none for unknown cases for some reason
-    cabi_free(ret.ptr);
     res.emplace(std::nullopt);
   } else {
-    ret.ptr = static_cast<uint8_t *>(cabi_realloc(ret.ptr, HOSTCALL_BUFFER_LEN, 1, ret.len));
-    res.emplace(make_host_string(ret));
+    res.emplace(HostString(std::string_view(buf, len)));
   }
 
   return res;
@@ -3130,25 +3523,54 @@ Result<std::optional<HostString>> Dict::get(std::string_view name) {
   Result<std::optional<HostString>> res;
 
   auto name_str = string_view_to_world_string(name);
-  fastly::fastly_world_string ret;
   fastly::fastly_host_error err;
 
-  ret.ptr = static_cast<uint8_t *>(cabi_malloc(DICTIONARY_ENTRY_MAX_LEN, 1));
+  HostcallArena::Scope scratch;
+  auto *buf = reinterpret_cast<char *>(scratch.alloc(DICTIONARY_ENTRY_MAX_LEN));
+  size_t len;
   if (!convert_result(fastly::dictionary_get(this->handle, reinterpret_cast<char *>(name_str.ptr),
-                                             name_str.len, reinterpret_cast<char *>(ret.ptr),
-                                             DICTIONARY_ENTRY_MAX_LEN, &ret.len),
+                                             name_str.len, buf, DICTIONARY_ENTRY_MAX_LEN, &len),
                       &err)) {
-    cabi_free(ret.ptr);
     if (error_is_optional_none(err)) {
       res.emplace(std::nullopt);
     } else {
       res.emplace_err(err);
     }
   } else {
-    ret.ptr = static_cast<uint8_t *>(cabi_realloc(ret.ptr, DICTIONARY_ENTRY_MAX_LEN, 1, ret.len));
-    res.emplace(make_host_string(ret));
+    res.emplace(HostString(std::string_view(buf, len)));
+  }
+
+  return res;
+}
+
+Result<Void> Dict::get_many(const std::vector<std::string_view> &names,
+                            const ConfigValueVisitor &visit) {
+  TRACE_CALL()
+  Result<Void> res;
+
+  HostcallArena::Scope scratch;
+  auto *buf = reinterpret_cast<char *>(scratch.alloc(DICTIONARY_ENTRY_MAX_LEN));
+  for (size_t i = 0; i < names.size(); i++) {
+    auto name_str = string_view_to_world_string(names[i]);
+    fastly::fastly_host_error err;
+    size_t len = 0;
+    std::optional<std::string_view> value;
+    if (!convert_result(fastly::dictionary_get(this->handle, reinterpret_cast<char *>(name_str.ptr),
+                                               name_str.len, buf, DICTIONARY_ENTRY_MAX_LEN, &len),
+                        &err)) {
+      if (!error_is_optional_none(err)) {
+        res.emplace_err(err);
+        return res;
+      }
+    } else {
+      value = std::string_view(buf, len);
+    }
+    if (!visit(i, value)) {
+      break;
+    }
   }
 
+  res.emplace();
   return res;
 }
 
@@ -3181,43 +3603,88 @@ Result<std::optional<HostString>> ConfigStore::get(std::string_view name,
 
   uint32_t buf_len{initial_buf_len};
   auto name_str = string_view_to_world_string(name);
-  fastly::fastly_world_string ret;
   fastly::fastly_host_error err;
 
-  ret.ptr = static_cast<uint8_t *>(cabi_malloc(buf_len, 1));
+  HostcallArena::Scope scratch;
+  auto *buf = reinterpret_cast<char *>(scratch.alloc(buf_len));
+  size_t len = 0;
 
-  bool succeeded{convert_result(
-      fastly::config_store_get(this->handle, reinterpret_cast<char *>(name_str.ptr), name_str.len,
-                               reinterpret_cast<char *>(ret.ptr), buf_len, &ret.len),
-      &err)};
+  bool succeeded{convert_result(fastly::config_store_get(this->handle,
+                                                         reinterpret_cast<char *>(name_str.ptr),
+                                                         name_str.len, buf, buf_len, &len),
+                                &err)};
 
   if (!succeeded && err == FASTLY_HOST_ERROR_BUFFER_LEN) {
     // NB(@zkat): ERROR_BUFFER_LEN sets the expected length of the buffer to
-    //            &ret.len, so we use that to inform our resize.
-    buf_len = ret.len;
-    ret.len = 0;
-    ret.ptr = static_cast<uint8_t *>(cabi_realloc(ret.ptr, initial_buf_len, 1, buf_len));
-    succeeded = convert_result(
-        fastly::config_store_get(this->handle, reinterpret_cast<char *>(name_str.ptr), name_str.len,
-                                 reinterpret_cast<char *>(ret.ptr), buf_len, &ret.len),
-        &err);
+    //            &len, so we use that to inform our resize.
+    buf_len = len;
+    len = 0;
+    buf = reinterpret_cast<char *>(scratch.alloc(buf_len));
+    succeeded = convert_result(fastly::config_store_get(this->handle,
+                                                        reinterpret_cast<char *>(name_str.ptr),
+                                                        name_str.len, buf, buf_len, &len),
+                               &err);
   }
 
   if (!succeeded) {
-    cabi_free(ret.ptr);
     if (error_is_optional_none(err)) {
       res.emplace(std::nullopt);
     } else {
       res.emplace_err(err);
     }
   } else {
-    ret.ptr = static_cast<uint8_t *>(cabi_realloc(ret.ptr, buf_len, 1, ret.len));
-    res.emplace(make_host_string(ret));
+    res.emplace(HostString(std::string_view(buf, len)));
   }
 
   return res;
 }
 
+Result<Void> ConfigStore::get_many(const std::vector<std::string_view> &names,
+                                   const ConfigValueVisitor &visit) {
+  TRACE_CALL()
+  Result<Void> res;
+
+  uint32_t buf_len{CONFIG_STORE_INITIAL_BUF_LEN};
+  HostcallArena::Scope scratch;
+  auto *buf = reinterpret_cast<char *>(scratch.alloc(buf_len));
+  for (size_t i = 0; i < names.size(); i++) {
+    auto name_str = string_view_to_world_string(names[i]);
+    fastly::fastly_host_error err;
+    size_t len = 0;
+    bool succeeded{convert_result(fastly::config_store_get(this->handle,
+                                                           reinterpret_cast<char *>(name_str.ptr),
+                                                           name_str.len, buf, buf_len, &len),
+                                  &err)};
+    if (!succeeded && err == FASTLY_HOST_ERROR_BUFFER_LEN) {
+      // As in `get`, the host reports the length it needs, and the larger buffer is kept for the
+      // remaining lookups.
+      buf_len = len;
+      len = 0;
+      buf = reinterpret_cast<char *>(scratch.alloc(buf_len));
+      succeeded = convert_result(fastly::config_store_get(this->handle,
+                                                          reinterpret_cast<char *>(name_str.ptr),
+                                                          name_str.len, buf, buf_len, &len),
+                                 &err);
+    }
+
+    std::optional<std::string_view> value;
+    if (!succeeded) {
+      if (!error_is_optional_none(err)) {
+        res.emplace_err(err);
+        return res;
+      }
+    } else {
+      value = std::string_view(buf, len);
+    }
+    if (!visit(i, value)) {
+      break;
+    }
+  }
+
+  res.emplace();
+  return res;
+}
+
 Result<ObjectStore> ObjectStore::open(std::string_view name) {
   TRACE_CALL()
   Result<ObjectStore> res;
@@ -3357,37 +3824,38 @@ Result<std::optional<HostBytes>> Secret::plaintext(uint32_t initial_buf_len) con
   Result<std::optional<HostBytes>> res;
 
   uint32_t buf_len{initial_buf_len};
-  fastly::fastly_world_list_u8 ret;
   fastly::fastly_host_error err;
-  ret.ptr = static_cast<uint8_t *>(JS_malloc(CONTEXT, buf_len));
-  bool succeeded{
-      convert_result(fastly::secret_store_plaintext(this->handle, reinterpret_cast<char *>(ret.ptr),
-                                                    buf_len, &ret.len),
-                     &err)};
+  HostcallArena::Scope scratch;
+  uint8_t *buf = scratch.alloc(buf_len);
+  size_t len = 0;
+  bool succeeded{convert_result(
+      fastly::secret_store_plaintext(this->handle, reinterpret_cast<char *>(buf), buf_len, &len),
+      &err)};
 
   if (!succeeded && err == FASTLY_HOST_ERROR_BUFFER_LEN) {
     // NB(@zkat): ERROR_BUFFER_LEN sets the expected length of the buffer to
-    //            &ret.len, so we use that to inform our resize.
-    buf_len = ret.len;
-    ret.len = 0;
-    ret.ptr = static_cast<uint8_t *>(JS_realloc(CONTEXT, ret.ptr, initial_buf_len, buf_len));
-    succeeded =
-        convert_result(fastly::secret_store_plaintext(
-                           this->handle, reinterpret_cast<char *>(ret.ptr), buf_len, &ret.len),
-                       &err);
+    //            &len, so we use that to inform our resize.
+    buf_len = len;
+    len = 0;
+    buf = scratch.alloc(buf_len);
+    succeeded = convert_result(
+        fastly::secret_store_plaintext(this->handle, reinterpret_cast<char *>(buf), buf_len, &len),
+        &err);
   }
 
   if (!succeeded) {
-    JS_free(CONTEXT, ret.ptr);
     if (error_is_optional_none(err)) {
       res.emplace(std::nullopt);
     } else {
       res.emplace_err(err);
     }
   } else {
-    ret.ptr = static_cast<uint8_t *>(JS_realloc(CONTEXT, ret.ptr, buf_len, ret.len));
-    res.emplace(make_host_bytes(ret.ptr, ret.len));
+    auto bytes = HostBytes::with_capacity(len);
+    std::copy(buf, buf + len, bytes.begin());
+    res.emplace(std::move(bytes));
   }
+  // Don't leave plaintext secrets behind in the arena for later hostcalls to see.
+  std::fill(buf, buf + buf_len, 0);
 
   return res;
 }
@@ -4801,6 +5269,18 @@ FastlyAsyncTask::Handle KVStorePendingLookup::async_handle() const {
   return FastlyAsyncTask::Handle{this->handle};
 }
 
+Result<bool> KVStorePendingLookup::is_ready() const {
+  Result<bool> res;
+  uint32_t is_ready;
+  fastly::fastly_host_error err;
+  if (!convert_result(fastly::async_is_ready(this->handle, &is_ready), &err)) {
+    res.emplace_err(err);
+  } else {
+    res.emplace(is_ready);
+  }
+  return res;
+}
+
 Result<KVStorePendingDelete::Handle> KVStore::delete_(std::string_view key) {
   TRACE_CALL()
   Result<KVStorePendingDelete::Handle> res;
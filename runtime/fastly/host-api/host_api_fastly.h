@@ -2,11 +2,13 @@
 #define FASTLY_HOST_API_H
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -158,9 +160,124 @@ using fastly::fetch::Request;
 
 namespace host_api {
 
+/// The header values last written to a request or response handle by `write_headers`, grouped by
+/// header name.
+using CommittedHeaders = std::unordered_map<std::string, std::vector<std::string>>;
+
+/// Write the given header list into `headers`, replacing any values the handle already has for
+/// the names in the list.
+///
+/// If `committed` is given, it must describe what the last call for the same handle wrote, and
+/// nothing else may have changed the handle's headers since. Only the differences are then written:
+/// names no longer in the list are removed, and names whose values changed are set again, while
+/// unchanged names cost no hostcalls at all. `committed` is updated to describe the new state.
 Result<Void>
 write_headers(HttpHeaders *headers,
-              std::vector<std::tuple<host_api::HostString, host_api::HostString>> &list);
+              std::vector<std::tuple<host_api::HostString, host_api::HostString>> &list,
+              CommittedHeaders *committed = nullptr);
+
+/// Scratch memory for hostcall wrappers.
+///
+/// Hostcalls returning variable-length data need a maximum-length buffer up front, which is thrown
+/// away as soon as the result has been copied out of it. Those buffers are bump-allocated from a
+/// per-sandbox arena instead of going through the general allocator on every call. Allocations
+/// are released when the `Scope` they were made in ends, and the arena keeps its memory across
+/// requests in reusable sandboxes.
+class HostcallArena final {
+public:
+  struct Stats {
+    /// Bytes currently held by the arena's block.
+    size_t capacity = 0;
+    /// Highest number of bytes in use at once since the sandbox started.
+    size_t peak_usage = 0;
+    /// Highest number of bytes in use at once during the current request.
+    size_t request_peak_usage = 0;
+    /// Allocations that did not fit in the arena's block and were made separately.
+    size_t overflow_allocations = 0;
+  };
+
+  /// A region of the arena; everything allocated from it is released when it is destroyed.
+  /// Scopes must be destroyed in the reverse order of their creation.
+  class Scope final {
+    size_t mark_;
+    size_t overflow_mark_;
+
+  public:
+    Scope();
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    /// Allocate `len` bytes, 8-byte aligned, that stay valid until this scope ends.
+    uint8_t *alloc(size_t len);
+  };
+
+  /// Release everything and, if the request overflowed the arena's block, grow the block to the
+  /// request's peak usage, up to a bounded size, so that later requests fit. Called at the end of
+  /// each request.
+  static void reset();
+
+  /// The most memory the arena keeps between requests. Allocations larger than this are always
+  /// made separately and freed again, so buffers that are allocated over and over, such as for
+  /// body reads, should be no larger than this.
+  static size_t max_retained_size();
+
+  static Stats stats();
+};
+
+/// Counters describing the work done by the event loop's `api::AsyncTask::select`, kept for the
+/// lifetime of the sandbox.
+struct AsyncSelectStats {
+  /// Number of times the event loop asked for the next task to run.
+  uint64_t select_calls = 0;
+  /// Number of `async_select` hostcalls made.
+  uint64_t host_selects = 0;
+  /// Number of `async_is_ready` hostcalls made.
+  uint64_t ready_checks = 0;
+  /// Number of handles found to be ready, whether handed out right away or kept for later calls.
+  uint64_t tasks_woken = 0;
+  /// Number of calls answered from handles found ready by an earlier call.
+  uint64_t ready_set_hits = 0;
+};
+
+AsyncSelectStats async_select_stats();
+
+/// Registers `hook` to be called whenever the event loop is about to wait for the host or for a
+/// timer, so that output buffered while running JS can be written out first.
+void add_event_loop_idle_hook(void (*hook)());
+
+/// Per-request profile of the calls made through this host API and of the time spent running the
+/// request handler. Unlike the `DEBUG`-only hostcall log, this is available in release builds, and
+/// costs nothing beyond a flag check while profiling is disabled.
+class Profiler final {
+public:
+  struct HostcallStats {
+    /// The host API function making the hostcall, such as `HttpBody::read`.
+    std::string name;
+    /// Number of calls made during the current request.
+    uint64_t calls = 0;
+    /// Wall time spent in those calls, in nanoseconds. Functions built on top of others, like
+    /// `HttpBody::write_all_back`, include the time spent in the calls they make themselves.
+    uint64_t nanoseconds = 0;
+  };
+
+  static bool enabled();
+  static void set_enabled(bool enabled);
+
+  /// Measure the wall time spent running the request's fetch event handlers.
+  static void begin_handler();
+  static void end_handler();
+  /// The handler time so far, including the time since `begin_handler` if the handlers are still
+  /// running, as they are when the profile is read from inside them.
+  static uint64_t handler_nanoseconds();
+
+  /// Every host API function called since profiling was first enabled. Those not called during
+  /// the current request have a count of zero.
+  static const std::vector<HostcallStats> &hostcalls();
+
+  /// Clear the profile. Called at the start of each request.
+  static void reset();
+};
 
 class FastlySendError final {
 public:
@@ -333,6 +450,39 @@ public:
   Result<bool> is_ready() const;
 };
 
+/// Chunk sizing policy for reads from an HttpBody.
+///
+/// Reads start at the body's known length when the host reports one (clamped to the sizer's
+/// bounds), and otherwise at the minimum chunk size. Every read that fills its whole chunk doubles
+/// the size of the next one, so long streamed bodies quickly move to large reads and need far
+/// fewer `body_read` hostcalls than a fixed chunk size.
+class BodyReadSizer final {
+public:
+  static constexpr size_t MIN_CHUNK_SIZE = 8192;
+  static constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+  BodyReadSizer() = default;
+  explicit BodyReadSizer(size_t chunk_size, size_t max_chunk_size = MAX_CHUNK_SIZE);
+
+  /// Create a sizer for the given body, using its known length as the first chunk size if the
+  /// host reports one. Errors from the length lookup are ignored and fall back to the default.
+  static BodyReadSizer for_body(const HttpBody &body, size_t max_chunk_size = MAX_CHUNK_SIZE);
+
+  /// The number of bytes to request on the next read.
+  size_t chunk_size() const { return chunk_size_; }
+
+  /// The body length reported by the host when this sizer was created, if any.
+  std::optional<uint64_t> known_length() const { return known_length_; }
+
+  /// Record the number of bytes returned by a read of `chunk_size()` bytes.
+  void record(size_t bytes_read);
+
+private:
+  size_t chunk_size_ = MIN_CHUNK_SIZE;
+  size_t max_chunk_size_ = MAX_CHUNK_SIZE;
+  std::optional<uint64_t> known_length_;
+};
+
 struct Response;
 
 class HttpPendingReq final {
@@ -901,6 +1051,11 @@ public:
   Result<Void> write(std::string_view msg);
 };
 
+/// Receives each value fetched by `Dict::get_many` or `ConfigStore::get_many`, along with the
+/// index of its name, or `std::nullopt` if there is no entry for that name. The value is only
+/// valid for the duration of the call. Returning false stops the remaining lookups.
+using ConfigValueVisitor = std::function<bool(size_t, std::optional<std::string_view>)>;
+
 class Dict final {
 public:
   using Handle = uint32_t;
@@ -915,6 +1070,9 @@ public:
   static Result<Dict> open(std::string_view name);
 
   Result<std::optional<HostString>> get(std::string_view name);
+  /// Look up each of `names` in turn, reusing a single buffer for all of the values.
+  Result<Void> get_many(const std::vector<std::string_view> &names,
+                        const ConfigValueVisitor &visit);
 };
 
 class ConfigStore final {
@@ -932,6 +1090,10 @@ public:
 
   Result<std::optional<HostString>> get(std::string_view name);
   Result<std::optional<HostString>> get(std::string_view name, uint32_t initial_buf_len);
+  /// Look up each of `names` in turn, reusing a single buffer for all of the values. The buffer
+  /// only grows when a value doesn't fit into it.
+  Result<Void> get_many(const std::vector<std::string_view> &names,
+                        const ConfigValueVisitor &visit);
 };
 
 class ObjectStorePendingLookup final {
@@ -1191,6 +1353,9 @@ public:
 
   /// Fetch the handle for this pending request.
   FastlyAsyncTask::Handle async_handle() const;
+
+  /// Check whether `wait` would return without blocking.
+  Result<bool> is_ready() const;
 };
 
 class KVStorePendingInsert final {
@@ -10,6 +10,32 @@ declare module 'fastly:acl' {
      */
     static open(aclName: string): Acl;
 
+    /**
+     * Caches the results of {@link Acl.lookup} in the sandbox, keyed by ACL name and IP address,
+     * so that repeated lookups within `maxAge` milliseconds don't need a hostcall.
+     */
+    static enableCache(options?: {
+      /** Maximum number of cached results, defaults to 1024. */
+      maxEntries?: number;
+      /** How long a result is cached, in milliseconds, defaults to 60000. */
+      maxAge?: number;
+    }): void;
+
+    /**
+     * Turns off the cache enabled by {@link Acl.enableCache}, discarding every cached result.
+     */
+    static disableCache(): void;
+
+    /**
+     * Returns counters for the cache enabled by {@link Acl.enableCache}.
+     */
+    static cacheStats(): {
+      hits: number;
+      misses: number;
+      evictions: number;
+      entries: number;
+    };
+
     /**
      * Lookup a given IP address in the ACL list.
      *
@@ -21,10 +47,10 @@ declare module 'fastly:acl' {
      *   evt.respondWith(new Response(result?.action === 'BLOCK' ? 'blocked' : 'allowed'));
      * });
      *
-     * @param ipAddress Ipv6 or IPv4 IP address string
+     * @param ipAddress Ipv6 or IPv4 IP address string, or its 4 or 16 raw octets such as `event.client.addressOctets`
      * @returns An object containing the ACL action and IP prefix if the given IP address matches an ACL entry, or null if there is no match.
      */
-    lookup(ipAddress: string): Promise<{
+    lookup(ipAddress: string | ArrayBuffer | ArrayBufferView): Promise<{
       action: 'ALLOW' | 'BLOCK';
       prefix: string;
     } | null>;
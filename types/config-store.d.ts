@@ -35,5 +35,35 @@ declare module 'fastly:config-store' {
      * @throws `TypeError` if the provided key is empty or longer than 255 characters.
      */
     get(key: string): string | null;
+    /**
+     * Get the values for several keys in the Config Store at once. The result has a
+     * property for each key, holding its value, or `null` if the key does not
+     * exist in the Config Store.
+     *
+     * @param keys The keys to retrieve.
+     * @throws `TypeError` if `keys` is not an array, or any key is empty or longer
+     *   than 255 characters.
+     */
+    getMany<K extends string>(keys: K[]): Record<K, string | null>;
+    /**
+     * Enable caching of `ConfigStore.prototype.get` and `Dictionary.prototype.get`
+     * lookups across requests handled by the same sandbox. Calling this again
+     * discards every cached entry and applies the new options.
+     *
+     * @param options.ttl How long a cached value may be used, in milliseconds. Defaults to 60000.
+     * @param options.maxEntries The maximum number of cached entries. Defaults to 1000.
+     * @throws `TypeError` if `options` is not an object.
+     * @throws `RangeError` if `ttl` is not a non-negative finite number, or `maxEntries`
+     *   is not a positive integer.
+     */
+    static enableCache(options?: { ttl?: number; maxEntries?: number }): void;
+    /**
+     * Disable the lookup cache and discard every cached entry.
+     */
+    static disableCache(): void;
+    /**
+     * Counters for the lookup cache.
+     */
+    static cacheStats(): { hits: number; misses: number; size: number };
   }
 }
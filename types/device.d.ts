@@ -17,6 +17,13 @@ declare module 'fastly:device' {
      */
     static lookup(useragent: string): Device | null;
 
+    /**
+     * Counters for the cache of `lookup` results. The most recently looked up User-Agents
+     * are cached by the sandbox, so that repeated lookups of the same User-Agent, including
+     * across requests handled by a reusable sandbox, don't need to be detected again.
+     */
+    static cacheStats(): { hits: number; misses: number; size: number };
+
     /**
      * The name of the device, or `null` if no name is known.
      */
@@ -28,5 +28,16 @@ declare module 'fastly:dictionary' {
      * @deprecated Use {@link config-store!ConfigStore | ConfigStore} from `'fastly:config-store'` instead.
      */
     get(key: string): string | null;
+    /**
+     * Get the values for several keys in the Dictionary at once. The result has a
+     * property for each key, holding its value, or `null` if the key does not
+     * exist in the Dictionary.
+     *
+     * @param keys The keys to retrieve.
+     * @throws `TypeError` if `keys` is not an array, or any key is empty or longer
+     *   than 255 characters.
+     * @deprecated Use {@link config-store!ConfigStore | ConfigStore} from `'fastly:config-store'` instead.
+     */
+    getMany<K extends string>(keys: K[]): Record<K, string | null>;
   }
 }
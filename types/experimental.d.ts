@@ -38,6 +38,50 @@ declare module 'fastly:experimental' {
    */
   export function enableDebugLogging(enabled: boolean): void;
 
+  /**
+   * Timing of a single host API function in a {@link Profile}.
+   * @experimental
+   */
+  export interface HostcallProfile {
+    /** Number of calls made during the current request. */
+    calls: number;
+    /**
+     * Wall time spent in those calls, in milliseconds. This includes time spent waiting on the
+     * host, such as for a body read or an event loop select to complete.
+     */
+    time: number;
+  }
+
+  /**
+   * Profile of the current request, as returned by {@link profile}.
+   * @experimental
+   */
+  export interface Profile {
+    /**
+     * Wall time spent running the fetch event handlers, in milliseconds. Read from inside a
+     * handler, this includes the time that handler has run so far.
+     */
+    handlerTime: number;
+    /** Hostcall timings, keyed by host API function name, such as `"HttpBody::read"`. */
+    hostcalls: Record<string, HostcallProfile>;
+  }
+
+  /**
+   * Enables or disables profiling, which counts and times every hostcall made while handling a
+   * request. Profiling stays enabled for later requests handled by the same sandbox.
+   *
+   * @param enabled Whether to profile requests.
+   * @experimental
+   */
+  export function enableProfiling(enabled: boolean): void;
+
+  /**
+   * Returns the profile of the current request so far, or `null` if profiling isn't enabled.
+   *
+   * @experimental
+   */
+  export function profile(): Profile | null;
+
   /**
    * Embed a file as a Uint8Array.
    *
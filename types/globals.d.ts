@@ -462,6 +462,12 @@ declare interface ClientInfo {
    * A string representation of the IPv4 or IPv6 address of the downstream client.
    */
   readonly address: string;
+  /**
+   * The 4 (IPv4) or 16 (IPv6) octets of the address of the downstream client, which can be
+   * passed to `Acl.prototype.lookup` without parsing the address again. Each access returns a new
+   * array.
+   */
+  readonly addressOctets: Uint8Array;
   /**
    * Geolocation data for the client IP address, or `null` if unavailable.
    */
@@ -1059,6 +1065,15 @@ declare interface Fastly {
    */
   enableDebugLogging(enabled: boolean): void;
 
+  /**
+   * Returns the profile of the current request so far, or `null` if profiling isn't enabled with
+   * {@link "fastly:experimental".enableProfiling}. This is the same function as
+   * {@link "fastly:experimental".profile}.
+   *
+   * @experimental
+   */
+  profile(): import('fastly:experimental').Profile | null;
+
   /**
    * Retrieve geolocation information about the given IP address.
    *
@@ -1498,6 +1513,14 @@ interface Request extends Body {
    * @param manual Whether to use manual mode for framing headers.
    */
   setManualFramingHeaders(manual: boolean): void;
+  /**
+   * Lowers the largest chunk, in bytes, that reads of this body's stream ask
+   * the host for. Reads start small and grow towards this size as the body
+   * keeps producing data, up to 1 MiB by default.
+   *
+   * @param size The largest chunk size, an integer between 8192 and 1048576.
+   */
+  setMaxBodyChunkSize(size: number): void;
 
   /**
    * Fastly-specific property - determines whether a request is cacheable per conservative RFC 9111 semantics.
@@ -1585,6 +1608,14 @@ interface Response extends Body {
    * @param manual Whether to use manual mode for framing headers.
    */
   setManualFramingHeaders(manual: boolean): void;
+  /**
+   * Lowers the largest chunk, in bytes, that reads of this body's stream ask
+   * the host for. Reads start small and grow towards this size as the body
+   * keeps producing data, up to 1 MiB by default.
+   *
+   * @param size The largest chunk size, an integer between 8192 and 1048576.
+   */
+  setMaxBodyChunkSize(size: number): void;
   /**
    * The backend this response was received from, or `undefined` for
    * user-created responses.
@@ -1,4 +1,19 @@
 declare module 'fastly:html-rewriter' {
+  /**
+   * Memory settings for an {@link HTMLRewritingStream}.
+   */
+  export interface HTMLRewritingStreamOptions {
+    /**
+     * Number of bytes to allocate up front for the parsing buffer. Defaults to 1024.
+     */
+    preallocatedParsingBufferSize?: number;
+    /**
+     * Maximum number of bytes the rewriter may use for buffering. If this is exceeded while
+     * rewriting, the stream errors. Defaults to no limit.
+     */
+    maxAllowedMemoryUsage?: number;
+  }
+
   /**
    * Lets you rewrite HTML by registering callbacks on CSS selectors. When an element matching the
    * selector is encountered, the rewriter calls your callback, which can manipulate the element's
@@ -31,7 +46,10 @@ declare module 'fastly:html-rewriter' {
    * @version 3.35.0
    */
   export class HTMLRewritingStream implements TransformStream {
-    constructor();
+    /**
+     * @param options Optional settings for the memory used by the underlying HTML parser.
+     */
+    constructor(options?: HTMLRewritingStreamOptions);
     /**
      * Registers a callback for elements matching the given CSS selector. The callback is called
      * once for each matching element. Elements added by handlers will not be processed by other
@@ -80,6 +98,52 @@ declare module 'fastly:html-rewriter' {
     readable: ReadableStream;
   }
 
+  /**
+   * A reusable set of element handlers from which {@link HTMLRewritingStream}s can be created.
+   *
+   * Building a template at the top level of your program, rather than inside the request
+   * handler, means the selectors are parsed and the handlers registered once during
+   * initialization. Each request then only pays for creating a stream from the template.
+   *
+   * @example
+   * ```js
+   * import { HTMLRewritingStreamTemplate } from 'fastly:html-rewriter';
+   *
+   * const rewriter = new HTMLRewritingStreamTemplate()
+   *   .onElement("h1", e => e.prepend("Header: "));
+   *
+   * addEventListener("fetch", (event) => event.respondWith((async () => {
+   *   let body = (await fetch("https://example.com/")).body.pipeThrough(rewriter.createStream());
+   *   return new Response(body, {
+   *     headers: { "content-type": "text/html; charset=utf-8" },
+   *   });
+   * })()));
+   * ```
+   */
+  export class HTMLRewritingStreamTemplate {
+    /**
+     * @param options Memory settings used by every stream created from this template.
+     */
+    constructor(options?: HTMLRewritingStreamOptions);
+    /**
+     * Registers a callback for elements matching the given CSS selector, in the same way as
+     * {@link HTMLRewritingStream.onElement}. Handlers can't be added once a stream has been
+     * created from the template.
+     *
+     * @param selector CSS selector string
+     * @param handler Function called with each matching Element
+     * @returns The HTMLRewritingStreamTemplate instance for chaining
+     * @throws `Error` If the provided selector is not a valid CSS selector, if the handler is not
+     * a function, or if a stream has already been created from the template.
+     */
+    onElement(selector: string, handler: (element: Element) => void): this;
+    /**
+     * Creates a new {@link HTMLRewritingStream} that uses this template's element handlers.
+     * Further handlers can't be added to the returned stream.
+     */
+    createStream(): HTMLRewritingStream;
+  }
+
   /**
    * Options for content insertion and replacement methods on {@link Element}.
    *
@@ -73,6 +73,25 @@ declare module 'fastly:kv-store' {
      */
     get(key: string): Promise<KVStoreEntry | null>;
 
+    /**
+     * Gets the values associated with several keys in the KV store at once.
+     *
+     * The lookups are all started together, or at most `options.concurrency` at a time, and
+     * the returned `Promise` resolves once all of them have completed. It resolves with a
+     * `Map` from each key, in the order of `keys`, to a `KVStoreEntry` for the key, or
+     * `null` if the key is absent.
+     *
+     * @param keys The keys to retrieve from within the KV store, with the same constraints as
+     * for {@link get}.
+     * @param options.concurrency The maximum number of lookups in flight at once.
+     * @throws Throws `TypeError` if `keys` is not an array, any key violates the constraints,
+     * or `options.concurrency` is not a positive integer.
+     */
+    getMany(
+      keys: string[],
+      options?: { concurrency?: number },
+    ): Promise<Map<string, KVStoreEntry | null>>;
+
     /**
      * Write the value of `value` into the KV store under the key `key`.
      *
@@ -161,6 +180,86 @@ declare module 'fastly:kv-store' {
        */
       cursor: string | undefined;
     }>;
+
+    /**
+     * Iterate over every key in the KV store, optionally filtered by prefix.
+     *
+     * Keys are listed a page at a time, and the next page is requested as soon as the
+     * current one arrives, so that it is usually ready by the time the current page has
+     * been consumed.
+     *
+     * @example
+     * ```js
+     * for await (const key of store.listAll({ prefix: 'user-' })) {
+     *   console.log(key);
+     * }
+     * ```
+     *
+     * @param options Options for filtering and paginating the key list.
+     * @throws Throws `TypeError` if `options` is not an object, `prefix` is not a string,
+     * `pageSize` is not a positive integer, or `noSync` is not a boolean.
+     */
+    listAll(options?: {
+      /**
+       * Do not wait to sync the key list, and instead immediately return the current
+       * cached key list. May be faster but possibly out of date.
+       */
+      noSync?: boolean;
+      /**
+       * String prefix for keys to list.
+       */
+      prefix?: string;
+      /**
+       * The number of keys to request per page.
+       */
+      pageSize?: number;
+    }): AsyncIterableIterator<string>;
+
+    /**
+     * Enable a cache of `get` results in front of every KV store, shared by all requests
+     * handled by the same sandbox. Values are cached with their metadata and generation,
+     * keyed by store name and key, and evicted least recently used first once the cache
+     * holds more than `maxBytes`.
+     *
+     * A cached value is returned from memory, without a lookup, for `maxAge` milliseconds.
+     * After that, the next `get` looks the key up again, and if the value's generation hasn't
+     * changed the cached copy is kept and renewed without being read again. Calls to `put` and
+     * `delete` made by the sandbox invalidate the key's cached value.
+     *
+     * Calling this again discards every cached value and applies the new options.
+     *
+     * @param options.maxBytes The maximum total size of cached keys, values and metadata.
+     * Defaults to 8 MiB.
+     * @param options.maxAge How long a cached value is used without a lookup, in
+     * milliseconds. Defaults to 60000.
+     * @throws Throws `TypeError` if `options` is not an object.
+     * @throws Throws `RangeError` if `maxBytes` is not a positive integer, or `maxAge` is not a
+     * non-negative finite number.
+     */
+    static enableCache(options?: { maxBytes?: number; maxAge?: number }): void;
+
+    /**
+     * Disable the cache enabled by `enableCache`, discarding every cached value.
+     */
+    static disableCache(): void;
+
+    /**
+     * Counters for the cache enabled by `enableCache`.
+     */
+    static cacheStats(): {
+      /** Lookups answered from the cache. */
+      hits: number;
+      /** Lookups made while the cache was enabled that needed a KV lookup. */
+      misses: number;
+      /** Values evicted to make room for others. */
+      evictions: number;
+      /** Expired values that were renewed because their generation hadn't changed. */
+      revalidations: number;
+      /** The number of values currently cached. */
+      entries: number;
+      /** The total size of the values currently cached. */
+      bytes: number;
+    };
   }
 
   /**
@@ -31,12 +31,31 @@ declare module 'fastly:logger' {
      * [named log endpoint](https://developer.fastly.com/learning/integrations/logging).
      *
      * @param name The name of the Fastly log endpoint to associate with this Logger instance.
+     * @param options.buffered Whether to send logged messages in newline-separated batches,
+     * written once 8 KiB has accumulated, when the application waits for I/O or timers, and at
+     * the end of the request, rather than one write per message. Defaults to false.
      */
-    constructor(name: string);
+    constructor(name: string, options?: { buffered?: boolean });
     /**
      * Send the given message, converted to a string, to this Logger instance's endpoint.
      */
     log(message: any): void;
+    /**
+     * Serialize the given record and send it to this Logger instance's endpoint, without first
+     * converting it to a JavaScript string.
+     *
+     * @param record The record to log. It's serialized like `JSON.stringify` would, and must have
+     * a JSON representation.
+     * @param options.format `"json"` (the default) to log the record as JSON, `"ndjson"` to
+     * terminate it with a newline, or `"kv"` to log an object's own enumerable properties as
+     * space-separated `key=value` pairs. In the `"kv"` format, strings without spaces, `=` or
+     * characters that need escaping are written as is, other values are written as JSON, and
+     * properties without a JSON representation are skipped.
+     */
+    logRecord(
+      record: any,
+      options?: { format?: 'json' | 'ndjson' | 'kv' },
+    ): void;
   }
 
   interface ConsoleLoggingOptions {
@@ -53,6 +72,14 @@ declare module 'fastly:logger' {
      * Defaults to false.
      */
     stderr?: boolean;
+    /**
+     * Whether to write the lines logged while handling a request in batches, once 8 KiB has
+     * accumulated, when the application waits for I/O or timers, and at the end of the request,
+     * rather than one write per line.
+     *
+     * Defaults to false.
+     */
+    buffered?: boolean;
   }
 
   /**